@@ -0,0 +1,89 @@
+#ifndef ASYNC_LOG_WRITER_HPP
+#define ASYNC_LOG_WRITER_HPP
+
+#include <atomic>
+#include <condition_variable>
+#include <cstddef>
+#include <cstdint>
+#include <fstream>
+#include <memory>
+#include <mutex>
+#include <string>
+#include <thread>
+#include <vector>
+#include "DataStructure.hpp"
+
+// One bar of the trading log: the candle and the balance at its start.
+struct LogRecord
+{
+    int64_t open_time;
+    float open;
+    float high;
+    float low;
+    float close;
+    double balance;
+};
+
+// Trading log written on a background thread. The simulating thread pushes fixed-size records into
+// a single-producer / single-consumer ring buffer; the writer thread converts them in batches, into
+// "Open time,Open,High,Low,Close,Balance" CSV rows or binary equity records (EquityLog.hpp), and
+// writes large blocks to a file that stays open until the writer is closed. Only one thread may push.
+class AsyncLogWriter
+{
+public:
+    // Opens path for appending and writes the header if the file is empty. A binary log records
+    // sourceCsv, the candles it refers to, in its header and is therefore always started afresh:
+    // path is truncated.
+    explicit AsyncLogWriter(const std::string &path, LogFormat format = LogFormat::Csv,
+                            const std::string &sourceCsv = "");
+    ~AsyncLogWriter();
+
+    AsyncLogWriter(const AsyncLogWriter &) = delete;
+    AsyncLogWriter &operator=(const AsyncLogWriter &) = delete;
+
+    bool isOpen() const { return m_File.is_open(); }
+
+    // Waits while the ring is full.
+    void push(const LogRecord &record)
+    {
+        const size_t head = m_Head.load(std::memory_order_relaxed);
+        while (head - m_TailCache >= RING_CAPACITY)
+        {
+            m_TailCache = m_Tail.load(std::memory_order_acquire);
+            if (head - m_TailCache >= RING_CAPACITY)
+                waitForSpace();
+        }
+        m_Ring[head & (RING_CAPACITY - 1)] = record;
+        m_Head.store(head + 1, std::memory_order_release);
+
+        // Wake the writer once a batch is worth formatting; otherwise it polls.
+        if (head - m_TailCache == WAKE_THRESHOLD)
+            m_Ready.notify_one();
+    }
+
+    // Writes everything pushed so far, then stops the writer thread and closes the file.
+    void close();
+
+private:
+    static constexpr size_t RING_CAPACITY = size_t(1) << 16; // records, a power of two
+    static constexpr size_t WAKE_THRESHOLD = RING_CAPACITY / 4;
+
+    void waitForSpace();
+    void writerLoop();
+
+    std::ofstream m_File;
+    LogFormat m_Format;
+    std::unique_ptr<LogRecord[]> m_Ring;
+
+    // Producer and consumer positions on separate cache lines; both only grow.
+    alignas(64) std::atomic<size_t> m_Head{0};
+    size_t m_TailCache = 0; // producer's last view of m_Tail
+    alignas(64) std::atomic<size_t> m_Tail{0};
+
+    std::atomic<bool> m_Stopping{false};
+    std::mutex m_SleepMutex;
+    std::condition_variable m_Ready;
+    std::thread m_Writer;
+};
+
+#endif // ASYNC_LOG_WRITER_HPP
@@ -0,0 +1,74 @@
+#ifndef CANDLE_CACHE_HPP
+#define CANDLE_CACHE_HPP
+
+#include <cstdint>
+#include <string>
+#include "CandleSeries.hpp"
+#include "MappedFile.hpp"
+
+// Versioned binary, columnar copy of a candle CSV stored next to it ("SYMBOL.csv" -> "SYMBOL.candles").
+//
+// Layout: a 128 byte CandleCacheHeader followed by the columns
+//   int64 open_time[row_count]  (epoch seconds, UTC)
+//   float open[row_count], high[row_count], low[row_count], close[row_count]
+// Every column starts on a 64 byte boundary. The header records the size, mtime and checksum of the
+// source CSV so a stale cache is detected and rebuilt.
+namespace CandleCache {
+
+    constexpr char MAGIC[8] = {'O', 'T', 'C', 'A', 'N', 'D', 'L', 'E'};
+    constexpr uint32_t VERSION = 2; // 2: rows with impossible dates are no longer cached
+    constexpr size_t COLUMN_ALIGNMENT = 64;
+
+    enum Column
+    {
+        COLUMN_TIME = 0,
+        COLUMN_OPEN,
+        COLUMN_HIGH,
+        COLUMN_LOW,
+        COLUMN_CLOSE,
+        COLUMN_COUNT
+    };
+
+    struct CandleCacheHeader
+    {
+        char magic[8];
+        uint32_t version;
+        uint32_t header_size;
+        uint64_t row_count;
+        int64_t bar_interval;      // seconds between consecutive rows (taken from the first two rows)
+        uint64_t source_size;
+        int64_t source_mtime;      // nanoseconds since epoch
+        uint64_t source_checksum;
+        uint64_t column_offset[COLUMN_COUNT];
+        uint8_t reserved[128 - 56 - 8 * COLUMN_COUNT];
+    };
+    static_assert(sizeof(CandleCacheHeader) == 128, "CandleCacheHeader must stay 128 bytes");
+
+    // Validated, mapped columns of a cache file.
+    struct Columns
+    {
+        MappedFile file;
+        size_t row_count = 0;
+        int64_t bar_interval = 0;
+        const int64_t *open_time = nullptr;
+        const float *open = nullptr;
+        const float *high = nullptr;
+        const float *low = nullptr;
+        const float *close = nullptr;
+    };
+
+    // Path of the cache file belonging to csvPath.
+    std::string cachePathFor(const std::string &csvPath);
+
+    // 64-bit checksum used to detect changes of the source CSV.
+    uint64_t checksum(const char *data, size_t size);
+
+    // Maps the cache of csvPath. Returns false if the cache is missing, invalid or stale.
+    bool open(const std::string &csvPath, Columns &columns);
+
+    // Writes the cache for csvPath from already parsed rows. Returns false on I/O errors.
+    bool write(const std::string &csvPath, const char *csvData, size_t csvSize, const CandleSeries &candles);
+
+}
+
+#endif // CANDLE_CACHE_HPP
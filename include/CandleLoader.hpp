@@ -0,0 +1,108 @@
+#ifndef CANDLE_LOADER_HPP
+#define CANDLE_LOADER_HPP
+
+#include <cstdint>
+#include <string>
+#include <vector>
+#include "DataStructure.hpp"
+#include "CandleSeries.hpp"
+
+namespace CandleLoader {
+
+    // Checks fixed-interval spacing incrementally while candles are materialized.
+    // Every problem is recorded; after an issue checking resumes from the offending timestamp.
+    class TimestampValidator
+    {
+    public:
+        TimestampValidator(ValidationReport *report, int64_t intervalSeconds)
+            : m_Report(report), m_Interval(intervalSeconds)
+        {
+            if (m_Report != nullptr)
+            {
+                m_Report->expected_interval = intervalSeconds;
+                m_Report->opened = false;
+                m_Report->row_count = 0;
+                m_Report->issues.clear();
+            }
+        }
+
+        void check(size_t line, int64_t timestamp)
+        {
+            if (m_Report == nullptr)
+                return;
+
+            if (m_Report->row_count++ > 0)
+            {
+                const int64_t expected = m_Previous + m_Interval;
+                if (timestamp != expected)
+                    m_Report->issues.push_back({line, expected, timestamp, classify(timestamp, expected)});
+            }
+            m_Previous = timestamp;
+        }
+
+        void opened()
+        {
+            if (m_Report != nullptr)
+                m_Report->opened = true;
+        }
+
+        void malformed(size_t line)
+        {
+            if (m_Report != nullptr)
+                m_Report->issues.push_back({line, m_Previous + m_Interval, 0, TimestampIssueType::Malformed});
+        }
+
+        // Appends the report of a chunk that was validated on its own by a validator with the same
+        // interval. The chunk's first row is cross-checked against the last row seen so far.
+        void merge(const ValidationReport &chunk, size_t rows, size_t firstRowLine,
+                   int64_t firstTimestamp, int64_t lastTimestamp)
+        {
+            if (m_Report == nullptr)
+                return;
+
+            auto issue = chunk.issues.begin();
+            // Malformed lines before the chunk's first row follow the rows merged so far.
+            for (; issue != chunk.issues.end() && (rows == 0 || issue->line < firstRowLine); ++issue)
+                m_Report->issues.push_back({issue->line, m_Previous + m_Interval, 0, issue->type});
+
+            if (rows == 0)
+                return;
+
+            check(firstRowLine, firstTimestamp);
+            m_Report->issues.insert(m_Report->issues.end(), issue, chunk.issues.end());
+            m_Report->row_count += rows - 1;
+            m_Previous = lastTimestamp;
+        }
+
+        bool enabled() const { return m_Report != nullptr; }
+        int64_t interval() const { return m_Interval; }
+
+    private:
+        TimestampIssueType classify(int64_t timestamp, int64_t expected) const
+        {
+            if (timestamp > expected)
+                return TimestampIssueType::Gap;
+            if (timestamp > m_Previous)
+                return TimestampIssueType::Misaligned;
+            if (timestamp == m_Previous)
+                return TimestampIssueType::Duplicate;
+            return TimestampIssueType::OutOfOrder;
+        }
+
+        ValidationReport *m_Report;
+        int64_t m_Interval;
+        int64_t m_Previous = 0;
+    };
+
+    // Loads "Open time,Open,High,Low,Close" candles from a CSV file through the binary cache next to
+    // it (see CandleCache.hpp). The CSV is memory mapped and parsed in place; the header line is skipped.
+    // The first call parses the CSV and writes the cache; later calls read the cache until the CSV changes.
+    CandleSeries load(const std::string &filename);
+
+    // Same as load, and validates in the same pass that consecutive rows are intervalSeconds apart.
+    // Every gap, misaligned, duplicate, out-of-order or malformed row is recorded in report.
+    CandleSeries load(const std::string &filename, int64_t intervalSeconds, ValidationReport &report);
+
+}
+
+#endif // CANDLE_LOADER_HPP
@@ -0,0 +1,223 @@
+#ifndef CANDLE_SERIES_HPP
+#define CANDLE_SERIES_HPP
+
+#include <algorithm>
+#include <cstddef>
+#include <cstdint>
+#include <cstring>
+#include <new>
+#include "DataStructure.hpp"
+
+// Structure-of-arrays candle container. Every column is a separate 64 byte aligned array so the
+// simulation kernels only pull the fields they read into cache and the compiler can vectorize scans.
+class CandleSeries
+{
+public:
+    static constexpr size_t ALIGNMENT = 64;
+
+    CandleSeries() = default;
+    explicit CandleSeries(size_t count) { resize(count); }
+
+    // Copies rows [begin, end) of other.
+    CandleSeries(const CandleSeries &other, size_t begin, size_t end)
+    {
+        resize(end - begin);
+        copyColumns(other, begin, 0, m_Size);
+    }
+
+    CandleSeries(const CandleSeries &other) : CandleSeries(other, 0, other.m_Size) {}
+
+    CandleSeries(CandleSeries &&other) noexcept { swap(other); }
+
+    CandleSeries &operator=(CandleSeries other) noexcept
+    {
+        swap(other);
+        return *this;
+    }
+
+    ~CandleSeries() { release(); }
+
+    void swap(CandleSeries &other) noexcept
+    {
+        std::swap(m_Size, other.m_Size);
+        std::swap(m_Capacity, other.m_Capacity);
+        std::swap(m_OpenTime, other.m_OpenTime);
+        std::swap(m_Open, other.m_Open);
+        std::swap(m_High, other.m_High);
+        std::swap(m_Low, other.m_Low);
+        std::swap(m_Close, other.m_Close);
+    }
+
+    size_t size() const { return m_Size; }
+    bool empty() const { return m_Size == 0; }
+
+    void reserve(size_t capacity)
+    {
+        if (capacity <= m_Capacity)
+            return;
+
+        CandleSeries grown;
+        grown.allocate(capacity);
+        grown.m_Size = m_Size;
+        grown.copyColumns(*this, 0, 0, m_Size);
+        swap(grown);
+    }
+
+    // New rows are left uninitialized.
+    void resize(size_t count)
+    {
+        reserve(count);
+        m_Size = count;
+    }
+
+    void push_back(const DataRow &row)
+    {
+        if (m_Size == m_Capacity)
+            reserve(std::max<size_t>(1024, m_Capacity * 2));
+        set(m_Size++, row);
+    }
+
+    void set(size_t i, const DataRow &row)
+    {
+        m_OpenTime[i] = row.open_time;
+        m_Open[i] = row.open;
+        m_High[i] = row.high;
+        m_Low[i] = row.low;
+        m_Close[i] = row.close;
+    }
+
+    DataRow row(size_t i) const { return DataRow{m_OpenTime[i], m_Open[i], m_High[i], m_Low[i], m_Close[i]}; }
+
+    // Moves count rows from index from to index to (ranges may overlap).
+    void moveRows(size_t from, size_t to, size_t count)
+    {
+        if (count == 0)
+            return;
+        std::memmove(m_OpenTime + to, m_OpenTime + from, count * sizeof(int64_t));
+        std::memmove(m_Open + to, m_Open + from, count * sizeof(float));
+        std::memmove(m_High + to, m_High + from, count * sizeof(float));
+        std::memmove(m_Low + to, m_Low + from, count * sizeof(float));
+        std::memmove(m_Close + to, m_Close + from, count * sizeof(float));
+    }
+
+    const int64_t *open_time() const { return m_OpenTime; }
+    const float *open() const { return m_Open; }
+    const float *high() const { return m_High; }
+    const float *low() const { return m_Low; }
+    const float *close() const { return m_Close; }
+
+    int64_t *open_time() { return m_OpenTime; }
+    float *open() { return m_Open; }
+    float *high() { return m_High; }
+    float *low() { return m_Low; }
+    float *close() { return m_Close; }
+
+private:
+    template <typename T>
+    static T *allocateColumn(size_t count)
+    {
+        return static_cast<T *>(::operator new(count * sizeof(T), std::align_val_t(ALIGNMENT)));
+    }
+
+    template <typename T>
+    static void freeColumn(T *column)
+    {
+        if (column != nullptr)
+            ::operator delete(column, std::align_val_t(ALIGNMENT));
+    }
+
+    void allocate(size_t capacity)
+    {
+        m_OpenTime = allocateColumn<int64_t>(capacity);
+        m_Open = allocateColumn<float>(capacity);
+        m_High = allocateColumn<float>(capacity);
+        m_Low = allocateColumn<float>(capacity);
+        m_Close = allocateColumn<float>(capacity);
+        m_Capacity = capacity;
+    }
+
+    void release()
+    {
+        freeColumn(m_OpenTime);
+        freeColumn(m_Open);
+        freeColumn(m_High);
+        freeColumn(m_Low);
+        freeColumn(m_Close);
+    }
+
+    void copyColumns(const CandleSeries &other, size_t from, size_t to, size_t count)
+    {
+        if (count == 0)
+            return;
+        std::memcpy(m_OpenTime + to, other.m_OpenTime + from, count * sizeof(int64_t));
+        std::memcpy(m_Open + to, other.m_Open + from, count * sizeof(float));
+        std::memcpy(m_High + to, other.m_High + from, count * sizeof(float));
+        std::memcpy(m_Low + to, other.m_Low + from, count * sizeof(float));
+        std::memcpy(m_Close + to, other.m_Close + from, count * sizeof(float));
+    }
+
+    size_t m_Size = 0;
+    size_t m_Capacity = 0;
+    int64_t *m_OpenTime = nullptr;
+    float *m_Open = nullptr;
+    float *m_High = nullptr;
+    float *m_Low = nullptr;
+    float *m_Close = nullptr;
+};
+
+// Non-owning, read-only window [begin, end) over a CandleSeries. Cheap to copy, so many workers can
+// read the same candles without duplicating them. Indices are relative to the start of the window.
+class CandleView
+{
+public:
+    CandleView() = default;
+    CandleView(const CandleSeries &series) : CandleView(series, 0, series.size()) {}
+    CandleView(const CandleSeries &series, size_t begin, size_t end)
+        : m_OpenTime(series.open_time() + begin),
+          m_Open(series.open() + begin),
+          m_High(series.high() + begin),
+          m_Low(series.low() + begin),
+          m_Close(series.close() + begin),
+          m_Size(end - begin),
+          m_Offset(begin)
+    {
+    }
+
+    // Window [begin, end) of this view.
+    CandleView subview(size_t begin, size_t end) const
+    {
+        CandleView view = *this;
+        view.m_OpenTime += begin;
+        view.m_Open += begin;
+        view.m_High += begin;
+        view.m_Low += begin;
+        view.m_Close += begin;
+        view.m_Size = end - begin;
+        view.m_Offset += begin;
+        return view;
+    }
+
+    size_t size() const { return m_Size; }
+    bool empty() const { return m_Size == 0; }
+    // Index of the first row of the view in the underlying series.
+    size_t offset() const { return m_Offset; }
+
+    DataRow row(size_t i) const { return DataRow{m_OpenTime[i], m_Open[i], m_High[i], m_Low[i], m_Close[i]}; }
+
+    const int64_t *open_time() const { return m_OpenTime; }
+    const float *open() const { return m_Open; }
+    const float *high() const { return m_High; }
+    const float *low() const { return m_Low; }
+    const float *close() const { return m_Close; }
+
+private:
+    const int64_t *m_OpenTime = nullptr;
+    const float *m_Open = nullptr;
+    const float *m_High = nullptr;
+    const float *m_Low = nullptr;
+    const float *m_Close = nullptr;
+    size_t m_Size = 0;
+    size_t m_Offset = 0;
+};
+
+#endif // CANDLE_SERIES_HPP
@@ -1,43 +1,88 @@
 #pragma once
 
+#include <cstdint>
+#include <memory>
 #include <vector>
 #include <string>
 #include <tuple>
+#include <array>
 
-struct DataRow {    std::string open_time;
+struct DataRow {
+    int64_t open_time; // epoch seconds (UTC); format with HelperFunctions::formatTimestamp
     float open;
     float high;
     float low;
     float close;
 };
 
+enum class TimestampIssueType
+{
+    Gap,        // later than previous + interval
+    Misaligned, // between previous and previous + interval
+    Duplicate,  // same as previous
+    OutOfOrder, // earlier than previous
+    Malformed   // row could not be parsed
+};
+
+struct TimestampIssue
+{
+    size_t line;      // line in the CSV file, the header being line 1
+    int64_t expected; // previous timestamp + interval (epoch seconds)
+    int64_t actual;   // timestamp found on the line, 0 if malformed
+    TimestampIssueType type;
+};
+
+// Result of validating the fixed-interval spacing of a candle file while it is loaded.
+struct ValidationReport
+{
+    int64_t expected_interval = 0; // seconds
+    bool opened = false;           // the file (or its cache) could be read; it may still have no rows
+    size_t row_count = 0;
+    std::vector<TimestampIssue> issues;
+
+    bool ok() const { return issues.empty(); }
+};
+
+enum class PositionSide : int8_t
+{
+    Flat,
+    Long,
+    Short
+};
+
+// One closed trade; bars are indices into the candle series. Stored column-wise by TradeLedger.
 struct Trade
 {
-    std::string open_time;
-    float opening_value;
-    float closing_value;
-    std::string direction;
-    float profit_or_loss;
+    uint64_t entry_bar;
+    uint64_t exit_bar;
+    int64_t entry_time;
+    int64_t exit_time;
+    PositionSide side;
+    float entry_price;
+    float exit_price;
+    float amount;       // value traded
+    double pnl;
+    double balance;     // after the exit
+    int sensitivity;
+    float tpsl;
 };
 
-struct TradingState
+// Everything the simulation kernels read or write per bar, kept within one cache line.
+struct PositionState
 {
-    bool in_position = false;
-    std::string position_type;
-    double entry_price = 0.0f;
-    double sl_price = 0.0f;
-    double tp_price = 0.0f;
-    double balance = 1000.0f;
-    double position_size = 0.0f;
-    double position_size_qty = 0.0f;
-    int total_wins = 0;
-    int total_losses = 0;
-    int trade_count_since_last_recalc = 0;
-    std::vector<Trade> trades;
-    float entry_atr =   0.0f;
-    float entry_adx = 0.0f;
-    std::string entry_time;
+    double entry_price = 0.0;
+    double sl_price = 0.0;
+    double tp_price = 0.0;
+    double position_size = 0.0;
+    double balance = 1000.0;
+    size_t trades_made = 0;
+    float next_amount = 0.0f;
+    int wait_counter = 0;
+    PositionSide side = PositionSide::Flat;
+
+    bool inPosition() const { return side != PositionSide::Flat; }
 };
+static_assert(sizeof(PositionState) <= 64, "PositionState should fit in one cache line");
 
 struct ResultHighBroke
 {
@@ -49,6 +94,14 @@ struct ResultHighBroke
     float best_win_rate = 0.0f;
 };
 
+// Format of the all_trading_logs_* balance log.
+enum class LogFormat
+{
+    Csv,    // "Open time,Open,High,Low,Close,Balance" text (.csv)
+    Binary, // open time and balance records, see EquityLog.hpp (.equity)
+    Events  // entries, exits and windows only, see TradeEventLog.hpp (all_trading_events_*.csv)
+};
+
 struct OptimizationParams {
     std::string csv_file;
     std::vector<int> sensitivity_values;
@@ -56,6 +109,14 @@ struct OptimizationParams {
     int lookback_days;
     size_t apply_trades;
     float commission_per_trade;
+    // Number of likely next windows optimized speculatively while the current one is optimized and
+    // applied; 0 runs the windows strictly one after another. Results do not depend on it.
+    size_t speculation_width = 0;
+    // Walk-forward stride in bars. 0 moves to the next window after apply_trades trades; otherwise
+    // window k starts stride_bars * k bars after the first one, all windows are optimized in parallel
+    // and then applied one after another over their own stride.
+    size_t stride_bars = 0;
+    LogFormat log_format = LogFormat::Csv;
     // Constructor for convenience
     OptimizationParams(const std::string& csv,
                        const std::vector<int>& sensitivity,
@@ -71,6 +132,8 @@ struct OptimizationParams {
           commission_per_trade(commission){}
 };
 
+class TradeLedger;
+
 struct OptimizationResult {
     float overall_balance;
     float overall_reduced_balance;
@@ -78,6 +141,8 @@ struct OptimizationResult {
     int wins;
     int losses;
     int total_trades;
+    // Trades closed by the applied windows, in order (see TradeLedger.hpp).
+    std::shared_ptr<const TradeLedger> trades;
 
     // Constructor for convenience
     OptimizationResult(float balance,
@@ -94,8 +159,14 @@ struct OptimizationResult {
           total_trades(tradeCount) {}
 };
 
+class AsyncLogWriter;
+class CandleView;
+class TradeEventLog;
+class ExitFinder;
+struct DonchianChannel;
+
 struct TradeSimulationParams {
-    std::vector<DataRow> &data;
+    const CandleView &data;
     int sensitivity;
     float tpsl;
     int &total_wins;
@@ -110,9 +181,29 @@ struct TradeSimulationParams {
     float &total_traded_volume;
     bool loggingEnabled = false;
     std::string logFileName = "";
+    // Optional open log shared by consecutive applying runs; when null simulateTradesApplying
+    // opens logFileName for the duration of the run.
+    AsyncLogWriter *log_writer = nullptr;
+    // Optional event log; when set it replaces the per-bar log.
+    TradeEventLog *event_log = nullptr;
+    // Optional ledger simulateTradesApplying records the closed trades in.
+    TradeLedger *ledger = nullptr;
+    // Optional precomputed Donchian channel, indexed like data (see DonchianChannels).
+    // When null the kernels track the channel themselves.
+    const float *channel_high = nullptr;
+    const float *channel_low = nullptr;
+    // Optional exit finder over the series behind data. With a precomputed channel the kernels
+    // jump from an entry straight to the bar where TP or SL is first hit.
+    const ExitFinder *exits = nullptr;
+    // Optional channel whose breakout index covers the series behind data. With a precomputed
+    // channel the kernels jump over flat bars straight to the next breakout.
+    const DonchianChannel *breakouts = nullptr;
+    // No positions are opened from this index of data on; the simulation stops at the first bar
+    // at or after it without an open position.
+    size_t entry_end_index = SIZE_MAX;
 
     // Constructor
-    TradeSimulationParams(std::vector<DataRow> &data_,
+    TradeSimulationParams(const CandleView &data_,
                           int sensitivity_,
                           float tpsl_,
                           int &total_wins_,
@@ -155,3 +246,34 @@ struct TradeSimulationResult {
           last_index(index),
           updated_next_amount(nextAmount) {}
 };
+
+// Number of tpsl values simulated together by simulateTradesOptimizingBatch (one per vector lane).
+constexpr size_t TPSL_LANES = 8;
+
+// One sensitivity with up to TPSL_LANES tpsl values; every lane sees the same breakout signals.
+struct TradeSimulationBatchParams {
+    const CandleView &data;
+    int sensitivity;
+    std::array<float, TPSL_LANES> tpsl{};
+    size_t lane_count = 0;
+    float multiplier = 1.0f;
+    size_t start_index = 0;
+    size_t max_trades = 0;
+    float initial_trade_size = 0.0f;
+    float starting_state_balance = 0.0f;
+    const float *channel_high = nullptr;
+    const float *channel_low = nullptr;
+    const ExitFinder *exits = nullptr;
+    const DonchianChannel *breakouts = nullptr;
+
+    TradeSimulationBatchParams(const CandleView &data_, int sensitivity_)
+        : data(data_), sensitivity(sensitivity_) {}
+};
+
+struct TradeSimulationBatchResult {
+    std::array<double, TPSL_LANES> final_balance{};
+    std::array<int, TPSL_LANES> wins{};
+    std::array<int, TPSL_LANES> losses{};
+    std::array<float, TPSL_LANES> traded_volume{};
+    std::array<float, TPSL_LANES> updated_next_amount{};
+};
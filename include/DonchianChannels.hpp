@@ -0,0 +1,41 @@
+#ifndef DONCHIAN_CHANNELS_HPP
+#define DONCHIAN_CHANNELS_HPP
+
+#include <cstdint>
+#include <vector>
+#include "CandleSeries.hpp"
+
+// Donchian channel of one sensitivity over a whole series:
+// high[i] / low[i] are the max / min of close[i - sensitivity, i) for i >= sensitivity.
+// Bit i of breakouts is set when close[i] leaves the channel (close > high or close < low), which
+// lets the kernels jump over the bars in between.
+struct DonchianChannel
+{
+    int sensitivity = 0;
+    std::vector<float> high;
+    std::vector<float> low;
+    std::vector<uint64_t> breakouts;
+
+    // First breakout bar in [from, end), or end if there is none.
+    size_t nextBreakout(size_t from, size_t end) const;
+};
+
+// Precomputed channels for a set of sensitivities. The channel does not depend on tpsl or on the
+// rolling window, so it is built once per series and shared by every combination and window.
+class DonchianChannels
+{
+public:
+    DonchianChannels() = default;
+    DonchianChannels(const CandleSeries &series, const std::vector<int> &sensitivities);
+
+    // Channel for the given sensitivity or nullptr if it was not precomputed.
+    const DonchianChannel *find(int sensitivity) const;
+
+    // Builds one channel with the van Herk/Gil-Werman algorithm (3 comparisons per bar, any window).
+    static DonchianChannel build(const float *close, size_t count, int sensitivity);
+
+private:
+    std::vector<DonchianChannel> m_Channels;
+};
+
+#endif // DONCHIAN_CHANNELS_HPP
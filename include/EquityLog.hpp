@@ -0,0 +1,56 @@
+#ifndef EQUITY_LOG_HPP
+#define EQUITY_LOG_HPP
+
+#include <cstdint>
+#include <string>
+#include "MappedFile.hpp"
+
+// Compact binary equity curve, the binary alternative to the all_trading_logs_*.csv trading log.
+//
+// Layout: an EquityLogHeader, the path of the source candle CSV (source_length bytes, no terminator),
+// padding up to header_size, then one EquityRecord per logged bar until the end of the file. The
+// candles themselves are not repeated; they are read back from the source's candle cache (see
+// CandleCache.hpp). Each run writes its own file, truncated when opened; only the apply windows of
+// that run append records to it.
+namespace EquityLog {
+
+    constexpr char MAGIC[8] = {'O', 'T', 'E', 'Q', 'U', 'I', 'T', 'Y'};
+    constexpr uint32_t VERSION = 1;
+    constexpr size_t HEADER_ALIGNMENT = 64;
+
+    struct EquityLogHeader
+    {
+        char magic[8];
+        uint32_t version;
+        uint32_t header_size;   // bytes before the first record
+        uint32_t record_size;
+        uint32_t source_length;
+    };
+    static_assert(sizeof(EquityLogHeader) == 24, "EquityLogHeader must stay 24 bytes");
+
+    // Balance at the start of the bar opening at open_time (epoch seconds, UTC).
+    struct EquityRecord
+    {
+        int64_t open_time;
+        double balance;
+    };
+    static_assert(sizeof(EquityRecord) == 16, "EquityRecord must stay 16 bytes");
+
+    // Header and source path of a new log, padded to header_size.
+    std::string header(const std::string &sourceCsv);
+
+    // Mapped records of a log file.
+    struct Curve
+    {
+        MappedFile file;
+        std::string source_csv;
+        size_t row_count = 0;
+        const EquityRecord *records = nullptr;
+    };
+
+    // Maps the log at path. Returns false if it is missing or not a valid log.
+    bool open(const std::string &path, Curve &curve);
+
+}
+
+#endif // EQUITY_LOG_HPP
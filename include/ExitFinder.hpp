@@ -0,0 +1,32 @@
+#ifndef EXIT_FINDER_HPP
+#define EXIT_FINDER_HPP
+
+#include <cstddef>
+#include <vector>
+#include "CandleSeries.hpp"
+
+// Finds the first bar at which an open position is closed, i.e. the first i in a range with
+// high[i] >= upper or low[i] <= lower (long: upper = tp, lower = sl; short: upper = sl, lower = tp).
+// The max of high / min of low is kept per block of BLOCK bars and per group of BLOCK blocks, so a
+// query skips quiet stretches a block or a group at a time instead of testing every bar.
+// Indices are positions in the series; the series must outlive the finder.
+class ExitFinder
+{
+public:
+    static constexpr size_t BLOCK = 64;
+
+    ExitFinder() = default;
+    explicit ExitFinder(const CandleSeries &series);
+
+    // First bar in [from, end) that hits upper or lower, or end if there is none.
+    size_t find(size_t from, size_t end, double upper, double lower) const;
+
+private:
+    const float *m_High = nullptr;
+    const float *m_Low = nullptr;
+    size_t m_Size = 0;
+    std::vector<float> m_BlockHigh, m_BlockLow; // per BLOCK bars
+    std::vector<float> m_GroupHigh, m_GroupLow; // per BLOCK * BLOCK bars
+};
+
+#endif // EXIT_FINDER_HPP
@@ -14,16 +14,22 @@
 #include <iomanip>
 #include <cmath>
 #include <thread>
-#include <mutex>
 #include "DataStructure.hpp"
+#include "CandleSeries.hpp"
+#include "DonchianChannels.hpp"
+#include "ExitFinder.hpp"
+#include "ThreadPool.hpp"
 
 class FibAlgoTrader
 {
 public:
-    FibAlgoTrader(float multiplier = 1.0f, int wait_counter = 5) : m_Multiplier(multiplier), m_WaitCounter(wait_counter) {}
+    // workers: size of the optimization thread pool, 0 for one per hardware thread.
+    FibAlgoTrader(float multiplier = 1.0f, int wait_counter = 5, size_t workers = 0)
+        : m_Multiplier(multiplier), m_WaitCounter(wait_counter), m_Pool(workers) {}
 
-    std::vector<DataRow> readCSV(const std::string &filename);
+    CandleSeries readCSV(const std::string &filename);
 
+    // Reentrant: runs for different parameters, or the same symbol, may execute concurrently.
     OptimizationResult performRollingWindowOptimization(
         const OptimizationParams &param,
         std::string logging_output_directory,
@@ -31,15 +37,20 @@ public:
     );
 
     ResultHighBroke optimizeParameters(
-        const std::vector<DataRow> &data,
+        const CandleView &data,
         const OptimizationParams &params,
-        float initialTradeSize
+        float initialTradeSize,
+        const DonchianChannels *channels = nullptr,
+        const ExitFinder *exits = nullptr
     );
 
     TradeSimulationResult simulateTradesApplying(TradeSimulationParams &params);
 
     TradeSimulationResult simulateTradesOptimizing(TradeSimulationParams &params);
 
+    // simulateTradesOptimizing for up to TPSL_LANES tpsl values of one sensitivity in a single pass.
+    TradeSimulationBatchResult simulateTradesOptimizingBatch(const TradeSimulationBatchParams &params);
+
     // Martingale multiplier
     float m_Multiplier;
 
@@ -48,8 +59,12 @@ public:
     // Cooldown after closing a trade.
     int m_WaitCounter = 5;
 
+    // Pool the optimization runs on; callers can queue independent runs on it as well.
+    ThreadPool &pool() { return m_Pool; }
+
 private:
-    std::mutex mtx;
+    // Runs the optimization simulations; created once and reused for every window.
+    ThreadPool m_Pool;
 };
 
 #endif // FIBALGO_TRADER_HPP
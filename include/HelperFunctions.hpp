@@ -4,11 +4,24 @@
 #include <string>
 #include <vector>
 #include <chrono>
+#include <cstdint>
 
 namespace HelperFunctions {
 
     std::string getFormattedDate();
 
+    // Parses a UTC "YYYY-MM-DD HH:MM:SS" timestamp into epoch seconds without going through iostreams.
+    bool parseTimestamp(const char *text, size_t length, int64_t &epochSeconds);
+
+    // Length of a "YYYY-MM-DD HH:MM:SS" timestamp.
+    constexpr size_t TIMESTAMP_LENGTH = 19;
+
+    // Formats epoch seconds back into "YYYY-MM-DD HH:MM:SS" (UTC).
+    std::string formatTimestamp(int64_t epochSeconds);
+
+    // Same, written to out[0, TIMESTAMP_LENGTH) without a terminator.
+    void formatTimestamp(int64_t epochSeconds, char *out);
+
     // Extracts symbols from files in the given directory.
     std::vector<std::string> get_symbols_from_directory(const std::string &directory_path);
 
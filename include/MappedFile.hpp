@@ -0,0 +1,35 @@
+#ifndef MAPPED_FILE_HPP
+#define MAPPED_FILE_HPP
+
+#include <cstddef>
+#include <string>
+
+// Read-only memory mapping of a whole file. Move-only; unmaps on destruction.
+class MappedFile
+{
+public:
+    MappedFile() = default;
+    explicit MappedFile(const std::string &path) { open(path); }
+    ~MappedFile() { close(); }
+
+    MappedFile(const MappedFile &) = delete;
+    MappedFile &operator=(const MappedFile &) = delete;
+    MappedFile(MappedFile &&other) noexcept;
+    MappedFile &operator=(MappedFile &&other) noexcept;
+
+    // Maps the file at path. Returns false if it cannot be opened or mapped.
+    bool open(const std::string &path);
+    void close();
+
+    bool is_open() const { return m_Open; }
+    const char *data() const { return m_Data; }
+    size_t size() const { return m_Size; }
+
+private:
+    const char *m_Data = nullptr;
+    size_t m_Size = 0;
+    // Empty files cannot be mapped but are still valid, open files.
+    bool m_Open = false;
+};
+
+#endif // MAPPED_FILE_HPP
@@ -0,0 +1,59 @@
+#ifndef RESULTS_SINK_HPP
+#define RESULTS_SINK_HPP
+
+#include <chrono>
+#include <cstddef>
+#include <fstream>
+#include <map>
+#include <mutex>
+#include <string>
+#include <vector>
+#include "nlohmann/json.hpp"
+
+enum class ResultsFormat
+{
+    Csv,  // header line, then one line per row with the columns in order
+    Json  // array of row objects
+};
+
+// Thread-safe, ordered output for results produced concurrently. Every row is submitted with its
+// slot number (0, 1, 2, ...) and kept in memory; a flush writes the rows whose earlier slots have all
+// arrived, in slot order, so the file is the same whatever order the producers finish in. Rows are
+// flushed by flush(), by the destructor and, with a flush interval, by the first submit after the
+// interval has passed.
+class ResultsSink
+{
+public:
+    // Creates (truncates) path. Rows are objects keyed by columns; missing keys are written empty.
+    ResultsSink(const std::string &path, std::vector<std::string> columns, ResultsFormat format = ResultsFormat::Csv,
+                std::chrono::milliseconds flushInterval = std::chrono::milliseconds::zero());
+    ~ResultsSink();
+
+    ResultsSink(const ResultsSink &) = delete;
+    ResultsSink &operator=(const ResultsSink &) = delete;
+
+    void submit(size_t slot, nlohmann::ordered_json row);
+
+    void flush();
+
+    // stem + extension, or stem_2 + extension, stem_3 + extension, ... for the first name that does
+    // not exist yet. The file is created empty, so concurrent callers never get the same name.
+    static std::string uniquePath(const std::string &stem, const std::string &extension);
+
+private:
+    void flushLocked();
+
+    std::mutex m_Mutex;
+    std::string m_Path;
+    std::vector<std::string> m_Columns;
+    ResultsFormat m_Format;
+    std::chrono::milliseconds m_FlushInterval;
+    std::chrono::steady_clock::time_point m_LastFlush;
+
+    std::ofstream m_File;                            // CSV: kept open, rows appended
+    nlohmann::ordered_json m_Written = nlohmann::ordered_json::array(); // JSON: rewritten on flush
+    size_t m_NextSlot = 0;
+    std::map<size_t, nlohmann::ordered_json> m_Waiting; // rows not written yet
+};
+
+#endif // RESULTS_SINK_HPP
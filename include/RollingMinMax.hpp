@@ -0,0 +1,58 @@
+#ifndef ROLLING_MIN_MAX_HPP
+#define ROLLING_MIN_MAX_HPP
+
+#include <cstddef>
+#include <vector>
+
+// Streaming maximum and minimum over the last `window` values pushed, using two monotonic deques
+// stored in one power-of-two ring buffer. push() is amortized O(1); max() and min() are O(1).
+// Indices passed to push() must be strictly increasing.
+class RollingMinMax
+{
+public:
+    explicit RollingMinMax(size_t window) : m_Window(window)
+    {
+        size_t capacity = 1;
+        while (capacity < window + 1)
+            capacity <<= 1;
+        m_Mask = capacity - 1;
+        m_MaxDeque.resize(capacity);
+        m_MinDeque.resize(capacity);
+    }
+
+    void push(size_t index, float value)
+    {
+        // Drop the entry that falls out of the window [index - window + 1, index].
+        if (m_MaxHead != m_MaxTail && m_MaxDeque[m_MaxHead & m_Mask].index + m_Window <= index)
+            ++m_MaxHead;
+        if (m_MinHead != m_MinTail && m_MinDeque[m_MinHead & m_Mask].index + m_Window <= index)
+            ++m_MinHead;
+
+        while (m_MaxHead != m_MaxTail && m_MaxDeque[(m_MaxTail - 1) & m_Mask].value <= value)
+            --m_MaxTail;
+        m_MaxDeque[m_MaxTail++ & m_Mask] = {index, value};
+
+        while (m_MinHead != m_MinTail && m_MinDeque[(m_MinTail - 1) & m_Mask].value >= value)
+            --m_MinTail;
+        m_MinDeque[m_MinTail++ & m_Mask] = {index, value};
+    }
+
+    float max() const { return m_MaxDeque[m_MaxHead & m_Mask].value; }
+    float min() const { return m_MinDeque[m_MinHead & m_Mask].value; }
+
+private:
+    struct Entry
+    {
+        size_t index;
+        float value;
+    };
+
+    size_t m_Window;
+    size_t m_Mask;
+    std::vector<Entry> m_MaxDeque;
+    std::vector<Entry> m_MinDeque;
+    size_t m_MaxHead = 0, m_MaxTail = 0;
+    size_t m_MinHead = 0, m_MinTail = 0;
+};
+
+#endif // ROLLING_MIN_MAX_HPP
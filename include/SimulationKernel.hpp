@@ -0,0 +1,291 @@
+#ifndef SIMULATION_KERNEL_HPP
+#define SIMULATION_KERNEL_HPP
+
+#include <algorithm>
+#include <cstddef>
+#include "AsyncLogWriter.hpp"
+#include "DataStructure.hpp"
+#include "CandleSeries.hpp"
+#include "DonchianChannels.hpp"
+#include "ExitFinder.hpp"
+#include "TradeEventLog.hpp"
+#include "TradeLedger.hpp"
+#include "RollingMinMax.hpp"
+
+// The breakout simulation shared by simulateTradesOptimizing and simulateTradesApplying. What differs
+// between them is chosen at compile time by policies, so the optimization instantiation carries no
+// logging code at all:
+//   Sizing   - trade size after a win / loss
+//   Exit     - which bars close an open position
+//   Observer - sees the balance at the start of every bar the simulation passes, and every entry
+//              and exit
+namespace SimulationKernel {
+
+    enum class ExitOutcome { None, Win, Loss };
+
+    // Trade size goes back to the initial size after a win (optimization runs).
+    struct ResetToInitialSize
+    {
+        static float afterWin(float, const TradeSimulationParams &params) { return params.initial_trade_size; }
+        static float afterLoss(float amount, const TradeSimulationParams &params) { return amount * params.multiplier; }
+    };
+
+    // Trade size goes back to the first balance of the run after a win (applied trades).
+    struct ResetToFirstBalance
+    {
+        static float afterWin(float, const TradeSimulationParams &params) { return params.first_balance; }
+        static float afterLoss(float amount, const TradeSimulationParams &params) { return amount * params.multiplier; }
+    };
+
+    // Closes a position once a bar reaches the take profit or the stop loss; take profit wins when a
+    // bar touches both. These are the thresholds ExitFinder searches for.
+    struct TakeProfitFirst
+    {
+        static ExitOutcome check(bool isLong, float high, float low, double tpPrice, double slPrice)
+        {
+            if (isLong)
+                return (high >= tpPrice) ? ExitOutcome::Win : (low <= slPrice) ? ExitOutcome::Loss : ExitOutcome::None;
+            return (low <= tpPrice) ? ExitOutcome::Win : (high >= slPrice) ? ExitOutcome::Loss : ExitOutcome::None;
+        }
+    };
+
+    struct NullObserver
+    {
+        void bar(size_t, double) {}
+        void bars(size_t, size_t, double) {}
+        void entry(size_t, const PositionState &) {}
+        void exit(size_t, const PositionState &, double, double) {}
+    };
+
+    // Queues one trading log row per bar on an AsyncLogWriter.
+    class LogObserver
+    {
+    public:
+        LogObserver(AsyncLogWriter &log, const CandleView &data) : m_Log(log), m_Data(data) {}
+
+        void bar(size_t i, double balance)
+        {
+            m_Log.push(LogRecord{m_Data.open_time()[i], m_Data.open()[i], m_Data.high()[i],
+                                 m_Data.low()[i], m_Data.close()[i], balance});
+        }
+
+        // Bars [begin, end) passed over with an unchanged balance.
+        void bars(size_t begin, size_t end, double balance)
+        {
+            for (size_t i = begin; i < end; ++i)
+                bar(i, balance);
+        }
+
+        void entry(size_t, const PositionState &) {}
+        void exit(size_t, const PositionState &, double, double) {}
+
+    private:
+        AsyncLogWriter &m_Log;
+        const CandleView &m_Data;
+    };
+
+    // Records entries and exits, with bar indices of the series behind data, on a TradeEventLog.
+    class EventObserver
+    {
+    public:
+        EventObserver(TradeEventLog &log, const CandleView &data) : m_Log(log), m_Data(data) {}
+
+        void bar(size_t, double) {}
+        void bars(size_t, size_t, double) {}
+
+        void entry(size_t i, const PositionState &state)
+        {
+            m_Log.entry(m_Data.offset() + i, m_Data.open_time()[i], state.side, state.entry_price, state.next_amount);
+        }
+
+        // Called with the balance already updated and the position not yet cleared.
+        void exit(size_t i, const PositionState &state, double price, double pnl)
+        {
+            m_Log.exit(m_Data.offset() + i, m_Data.open_time()[i], state.side, price, pnl, state.balance);
+        }
+
+    private:
+        TradeEventLog &m_Log;
+        const CandleView &m_Data;
+    };
+
+    // Records every closed trade in a TradeLedger and passes everything on to Observer.
+    template <class Observer>
+    class RecordingObserver
+    {
+    public:
+        RecordingObserver(Observer &inner, TradeLedger &ledger, const TradeSimulationParams &params)
+            : m_Inner(inner), m_Ledger(ledger), m_Params(params) {}
+
+        void bar(size_t i, double balance) { m_Inner.bar(i, balance); }
+        void bars(size_t begin, size_t end, double balance) { m_Inner.bars(begin, end, balance); }
+
+        void entry(size_t i, const PositionState &state)
+        {
+            m_EntryBar = i;
+            m_Inner.entry(i, state);
+        }
+
+        void exit(size_t i, const PositionState &state, double price, double pnl)
+        {
+            const CandleView &data = m_Params.data;
+            const size_t offset = data.offset();
+            m_Ledger.record(Trade{offset + m_EntryBar, offset + i, data.open_time()[m_EntryBar], data.open_time()[i],
+                                  state.side, static_cast<float>(state.entry_price), static_cast<float>(price),
+                                  state.next_amount, pnl, state.balance, m_Params.sensitivity, m_Params.tpsl});
+            m_Inner.exit(i, state, price, pnl);
+        }
+
+    private:
+        Observer &m_Inner;
+        TradeLedger &m_Ledger;
+        const TradeSimulationParams &m_Params;
+        size_t m_EntryBar = 0;
+    };
+
+    // Bar of data at or after `from` on which a position with the given targets is closed, or
+    // data.size() if it stays open to the end of the view.
+    inline size_t findExitBar(const ExitFinder &exits, const CandleView &data, size_t from,
+                              bool isLong, double tpPrice, double slPrice)
+    {
+        const size_t offset = data.offset();
+        const double upper = isLong ? tpPrice : slPrice;
+        const double lower = isLong ? slPrice : tpPrice;
+        return exits.find(offset + from, offset + data.size(), upper, lower) - offset;
+    }
+
+    // First breakout bar of data at or after `from`, or data.size() if there is none.
+    inline size_t findBreakoutBar(const DonchianChannel &channel, const CandleView &data, size_t from)
+    {
+        const size_t offset = data.offset();
+        return channel.nextBreakout(offset + from, offset + data.size()) - offset;
+    }
+
+    // Simulates one sensitivity / tpsl combination from params.start_index until the end of the data
+    // or params.max_trades closed trades. last_index of the result is the bar the loop stopped at.
+    template <class Sizing, class Exit, class Observer>
+    TradeSimulationResult run(TradeSimulationParams &params, Observer &observer)
+    {
+        const size_t dataSize = params.data.size();
+        const float *closes = params.data.close();
+        const float *highs = params.data.high();
+        const float *lows = params.data.low();
+        PositionState state;
+        state.balance = params.starting_state_balance;
+        state.next_amount = params.initial_trade_size;
+        size_t i = params.start_index;
+        const int waitCounterConst = 5;
+        state.wait_counter = waitCounterConst;
+
+        // Rolling high/low of the closes [i - sensitivity, i): read from the precomputed channel when
+        // available, otherwise updated in amortized O(1) per bar.
+        const size_t sensitivity = static_cast<size_t>(params.sensitivity);
+        const float *channelHigh = params.channel_high;
+        const float *channelLow = params.channel_low;
+        const bool trackChannel = (channelHigh == nullptr || channelLow == nullptr);
+        RollingMinMax channel(trackChannel ? sensitivity : 0);
+        for (size_t j = (i > sensitivity ? i - sensitivity : 0); trackChannel && j < i; ++j)
+            channel.push(j, closes[j]);
+        // Jumping to exits and breakouts needs the precomputed channel; the rolling one must see every bar.
+        const bool skipAhead = (params.exits != nullptr && !trackChannel);
+        const bool skipFlat = (params.breakouts != nullptr && !trackChannel);
+
+        // Continues the loop at `bar`; the observer still sees the bars passed over. A flat position
+        // never skips past entry_end_index, where the loop stops.
+        auto skipTo = [&](size_t bar)
+        {
+            if (!state.inPosition())
+                bar = std::min(bar, std::max(params.entry_end_index, i + 1));
+            observer.bars(i + 1, bar, state.balance);
+            i = bar - 1;
+        };
+
+        for (; i < dataSize && state.trades_made < params.max_trades; ++i)
+        {
+            if (i >= params.entry_end_index && !state.inPosition())
+                break;
+
+            if (trackChannel && i > params.start_index)
+                channel.push(i - 1, closes[i - 1]);
+
+            observer.bar(i, state.balance);
+
+            if (state.wait_counter > 0)
+            {
+                state.wait_counter--;
+                continue;
+            }
+
+            // A zero-width channel is the bar's own close, which it never breaks out of.
+            if (sensitivity == 0 || i < sensitivity)
+                continue;
+
+            // Donchian channel of the previous `sensitivity` closes.
+            float high = trackChannel ? channel.max() : channelHigh[i];
+            float low = trackChannel ? channel.min() : channelLow[i];
+            bool longCondition = (closes[i] > high);
+            bool shortCondition = (closes[i] < low);
+
+            if (!state.inPosition())
+            {
+                if (longCondition || shortCondition)
+                {
+                    state.side = longCondition ? PositionSide::Long : PositionSide::Short;
+                    state.entry_price = closes[i];
+                    state.position_size = state.next_amount / state.entry_price;
+                    state.tp_price = state.entry_price * (longCondition ? 1.0f + params.tpsl : 1.0f - params.tpsl);
+                    state.sl_price = state.entry_price * (longCondition ? 1.0f - params.tpsl : 1.0f + params.tpsl);
+                    params.total_traded_volume += state.next_amount;
+                    observer.entry(i, state);
+                }
+
+                // Nothing changes until the position is closed or the next breakout, so continue there.
+                if (state.inPosition() && skipAhead)
+                    skipTo(findExitBar(*params.exits, params.data, i + 1, longCondition,
+                                       state.tp_price, state.sl_price));
+                else if (!state.inPosition() && skipFlat)
+                    skipTo(findBreakoutBar(*params.breakouts, params.data, i + 1));
+                continue;
+            }
+
+            const bool isLong = (state.side == PositionSide::Long);
+            const ExitOutcome outcome = Exit::check(isLong, highs[i], lows[i], state.tp_price, state.sl_price);
+            if (outcome == ExitOutcome::None)
+                continue;
+
+            if (outcome == ExitOutcome::Win)
+            {
+                double profit = state.position_size * (isLong ? state.tp_price - state.entry_price
+                                                              : state.entry_price - state.tp_price);
+                state.balance += profit;
+                observer.exit(i, state, state.tp_price, profit);
+                params.total_wins++;
+                state.next_amount = Sizing::afterWin(state.next_amount, params);
+            }
+            else
+            {
+                double loss = state.position_size * (isLong ? state.entry_price - state.sl_price
+                                                            : state.sl_price - state.entry_price);
+                state.balance -= loss;
+                observer.exit(i, state, state.sl_price, -loss);
+                params.total_losses++;
+                state.next_amount = Sizing::afterLoss(state.next_amount, params);
+            }
+            state.side = PositionSide::Flat;
+            state.trades_made++;
+            state.wait_counter = waitCounterConst;
+
+            // After a close the wait counter runs down, then only a breakout opens a position.
+            if (skipFlat && state.trades_made < params.max_trades)
+            {
+                skipTo(findBreakoutBar(*params.breakouts, params.data, i + 1 + state.wait_counter));
+                state.wait_counter = 0;
+            }
+        }
+
+        return TradeSimulationResult{state.balance, i, state.next_amount};
+    }
+
+}
+
+#endif // SIMULATION_KERNEL_HPP
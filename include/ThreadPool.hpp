@@ -0,0 +1,126 @@
+#ifndef THREAD_POOL_HPP
+#define THREAD_POOL_HPP
+
+#include <atomic>
+#include <condition_variable>
+#include <cstddef>
+#include <deque>
+#include <exception>
+#include <functional>
+#include <future>
+#include <memory>
+#include <mutex>
+#include <thread>
+#include <type_traits>
+#include <vector>
+
+// Work-stealing pool. Every worker has its own deque: tasks submitted from a worker go to the back
+// of its deque and it pops from the back (newest first), while idle workers steal from the front of
+// the others (oldest, usually the largest pieces of work). Tasks submitted from outside the pool go
+// to a shared injection queue. Nested parallelism goes through TaskGroup, whose wait() runs the
+// group's own queued tasks instead of idling a worker.
+class ThreadPool
+{
+public:
+    // 0 workers means one per hardware thread.
+    explicit ThreadPool(size_t workers = 0);
+    ~ThreadPool();
+
+    ThreadPool(const ThreadPool &) = delete;
+    ThreadPool &operator=(const ThreadPool &) = delete;
+
+    size_t size() const { return m_Workers.size(); }
+
+    // Queues task and returns a future for its result; exceptions are rethrown by future::get().
+    // Blocking on the future from inside a task ties up a worker; use a TaskGroup there.
+    template <class F>
+    std::future<std::invoke_result_t<F>> submit(F &&task)
+    {
+        using Result = std::invoke_result_t<F>;
+        auto packaged = std::make_shared<std::packaged_task<Result()>>(std::forward<F>(task));
+        std::future<Result> result = packaged->get_future();
+        enqueue([packaged]() { (*packaged)(); });
+        return result;
+    }
+
+    void enqueue(std::function<void()> task);
+
+private:
+    struct WorkQueue
+    {
+        std::mutex mutex;
+        std::deque<std::function<void()>> tasks;
+    };
+
+    bool take(size_t self, std::function<void()> &task);
+    void workerLoop(size_t index);
+
+    std::vector<std::unique_ptr<WorkQueue>> m_Queues; // one per worker
+    WorkQueue m_Injected;                            // tasks from outside the pool
+    std::vector<std::thread> m_Workers;
+
+    std::atomic<size_t> m_Queued{0};
+    std::mutex m_SleepMutex;
+    std::condition_variable m_Ready;
+    bool m_Stopping = false;
+};
+
+// Set of tasks that can be waited for together. The group keeps its tasks until a pool worker or
+// wait() starts them: wait() runs the group's own tasks that no worker has started yet and otherwise
+// blocks, so it never picks up unrelated work (such as another caller's whole optimization) onto the
+// waiting thread's stack. Groups can be nested inside pool tasks to any depth. The first exception
+// thrown by a task is rethrown from wait(). Destroying a group drops the tasks not started yet and
+// waits for the running ones.
+class TaskGroup
+{
+public:
+    explicit TaskGroup(ThreadPool &pool) : m_Pool(pool), m_State(std::make_shared<State>()) {}
+    ~TaskGroup();
+
+    TaskGroup(const TaskGroup &) = delete;
+    TaskGroup &operator=(const TaskGroup &) = delete;
+
+    template <class F>
+    void run(F &&task)
+    {
+        {
+            std::lock_guard<std::mutex> lock(m_State->mutex);
+            ++m_State->pending;
+            m_State->queued.emplace_back(std::forward<F>(task));
+        }
+        m_State->changed.notify_all();
+        // The pool task starts the oldest task of the group still queued; it finds none if wait()
+        // got there first. It owns the state, so it may run after the group is gone.
+        m_Pool.enqueue([state = m_State]() { state->runNext(false); });
+    }
+
+    void wait();
+
+    // True once every task run so far has completed.
+    bool finished() const
+    {
+        std::lock_guard<std::mutex> lock(m_State->mutex);
+        return m_State->pending == 0;
+    }
+
+private:
+    struct State
+    {
+        std::mutex mutex;
+        std::condition_variable changed;           // a task was queued or finished
+        std::deque<std::function<void()>> queued;  // tasks not started yet
+        size_t pending = 0;                        // tasks not finished yet
+        std::exception_ptr error;
+
+        // Runs the newest or the oldest queued task. Returns false if there is none.
+        bool runNext(bool newest);
+    };
+
+    // Runs queued tasks of the group on this thread until every task has finished.
+    void complete();
+
+    ThreadPool &m_Pool;
+    std::shared_ptr<State> m_State;
+};
+
+#endif // THREAD_POOL_HPP
@@ -0,0 +1,57 @@
+#ifndef TRADE_EVENT_LOG_HPP
+#define TRADE_EVENT_LOG_HPP
+
+#include <cstddef>
+#include <cstdint>
+#include <fstream>
+#include <optional>
+#include <string>
+#include <vector>
+#include "CandleSeries.hpp"
+#include "DataStructure.hpp"
+#include "EquityLog.hpp"
+
+// Event-only trading log: one CSV row per window, entry, exit and window end instead of one per bar.
+//
+//   Event,Bar,Open time,Side,Price,Amount,PnL,Balance,Sensitivity,TPSL
+//
+// Bar is the index into the candle series, Sensitivity and TPSL are the parameters of the window in
+// force. Balances are written with full precision, so the per-bar balance curve can be rebuilt from
+// the events and the candles (reconstructCurve): a window's bars [Window.Bar, End.Bar) start at the
+// window balance, and every Exit changes it from the bar after the exit on.
+class TradeEventLog
+{
+public:
+    // Creates (truncates) path and writes the header; the curve of a log is rebuilt from one run only.
+    explicit TradeEventLog(const std::string &path);
+    ~TradeEventLog();
+
+    TradeEventLog(const TradeEventLog &) = delete;
+    TradeEventLog &operator=(const TradeEventLog &) = delete;
+
+    bool isOpen() const { return m_File.is_open(); }
+
+    // Starts a window applying sensitivity / tpsl from bar on.
+    void window(size_t bar, int64_t openTime, double balance, double amount, int sensitivity, float tpsl);
+    void entry(size_t bar, int64_t openTime, PositionSide side, double price, double amount);
+    void exit(size_t bar, int64_t openTime, PositionSide side, double price, double pnl, double balance);
+    // Ends the window before bar; openTime is empty when bar is past the end of the candles.
+    void end(size_t bar, std::optional<int64_t> openTime, double balance);
+
+    // Rebuilds the per-bar balance curve of the log at path. Returns false if the file cannot be read
+    // or does not match candles.
+    static bool reconstructCurve(const std::string &path, const CandleSeries &candles,
+                                 std::vector<EquityLog::EquityRecord> &curve);
+
+private:
+    void row(const char *event, size_t bar, std::optional<int64_t> openTime, PositionSide side,
+             std::optional<double> price, std::optional<double> amount, std::optional<double> pnl,
+             std::optional<double> balance);
+
+    std::ofstream m_File;
+    std::string m_Buffer; // rows not written yet
+    int m_Sensitivity = 0;
+    float m_Tpsl = 0.0f;
+};
+
+#endif // TRADE_EVENT_LOG_HPP
@@ -0,0 +1,89 @@
+#ifndef TRADE_LEDGER_HPP
+#define TRADE_LEDGER_HPP
+
+#include <cstddef>
+#include <cstdint>
+#include <memory>
+#include <string>
+#include "DataStructure.hpp"
+
+// Closed trades of a run, stored column by column in one arena allocated per ledger. Recording a
+// trade is a handful of stores; the arena only grows (doubling, columns copied) when the capacity
+// given up front runs out. The columns can be read directly or exported in bulk.
+class TradeLedger
+{
+public:
+    explicit TradeLedger(size_t capacity = 1024);
+
+    TradeLedger(const TradeLedger &) = delete;
+    TradeLedger &operator=(const TradeLedger &) = delete;
+
+    void record(const Trade &trade)
+    {
+        if (m_Size == m_Capacity)
+            grow();
+        const size_t n = m_Size++;
+        m_EntryBar[n] = trade.entry_bar;
+        m_ExitBar[n] = trade.exit_bar;
+        m_EntryTime[n] = trade.entry_time;
+        m_ExitTime[n] = trade.exit_time;
+        m_Pnl[n] = trade.pnl;
+        m_Balance[n] = trade.balance;
+        m_EntryPrice[n] = trade.entry_price;
+        m_ExitPrice[n] = trade.exit_price;
+        m_Amount[n] = trade.amount;
+        m_Tpsl[n] = trade.tpsl;
+        m_Sensitivity[n] = trade.sensitivity;
+        m_Side[n] = trade.side;
+    }
+
+    size_t size() const { return m_Size; }
+    bool empty() const { return m_Size == 0; }
+
+    Trade operator[](size_t n) const
+    {
+        return Trade{m_EntryBar[n], m_ExitBar[n], m_EntryTime[n], m_ExitTime[n], m_Side[n], m_EntryPrice[n],
+                     m_ExitPrice[n], m_Amount[n], m_Pnl[n], m_Balance[n], m_Sensitivity[n], m_Tpsl[n]};
+    }
+
+    // Columns of size() values each.
+    const uint64_t *entryBar() const { return m_EntryBar; }
+    const uint64_t *exitBar() const { return m_ExitBar; }
+    const int64_t *entryTime() const { return m_EntryTime; }
+    const int64_t *exitTime() const { return m_ExitTime; }
+    const PositionSide *side() const { return m_Side; }
+    const float *entryPrice() const { return m_EntryPrice; }
+    const float *exitPrice() const { return m_ExitPrice; }
+    const float *amount() const { return m_Amount; }
+    const double *pnl() const { return m_Pnl; }
+    const double *balance() const { return m_Balance; }
+    const int *sensitivity() const { return m_Sensitivity; }
+    const float *tpsl() const { return m_Tpsl; }
+
+    // Writes all trades as CSV in one piece. Returns false on I/O errors.
+    bool writeCsv(const std::string &path) const;
+
+private:
+    // Moves the columns to an arena with room for capacity trades.
+    void allocate(size_t capacity);
+    void grow() { allocate(m_Capacity > 0 ? m_Capacity * 2 : 64); }
+
+    std::unique_ptr<std::byte[]> m_Arena;
+    size_t m_Size = 0;
+    size_t m_Capacity = 0;
+
+    uint64_t *m_EntryBar = nullptr;
+    uint64_t *m_ExitBar = nullptr;
+    int64_t *m_EntryTime = nullptr;
+    int64_t *m_ExitTime = nullptr;
+    double *m_Pnl = nullptr;
+    double *m_Balance = nullptr;
+    float *m_EntryPrice = nullptr;
+    float *m_ExitPrice = nullptr;
+    float *m_Amount = nullptr;
+    float *m_Tpsl = nullptr;
+    int *m_Sensitivity = nullptr;
+    PositionSide *m_Side = nullptr;
+};
+
+#endif // TRADE_LEDGER_HPP
@@ -0,0 +1,141 @@
+#include "AsyncLogWriter.hpp"
+#include "EquityLog.hpp"
+#include "HelperFunctions.hpp"
+
+#include <charconv>
+#include <chrono>
+#include <cstring>
+#include <iostream>
+
+namespace {
+    constexpr size_t WRITE_BLOCK = size_t(1) << 20; // bytes handed to the file at once
+    constexpr size_t MAX_LINE = 128;                // upper bound of one formatted record
+    constexpr size_t FORMAT_BATCH = 4096;           // records formatted before the tail is released
+
+    // Same text as the default ostream formatting (%g, 6 significant digits).
+    inline char *writeNumber(char *out, double value)
+    {
+        return std::to_chars(out, out + 32, value, std::chars_format::general, 6).ptr;
+    }
+
+    char *formatRecord(char *out, const LogRecord &record)
+    {
+        HelperFunctions::formatTimestamp(record.open_time, out);
+        out += HelperFunctions::TIMESTAMP_LENGTH;
+        *out++ = ',';
+        out = writeNumber(out, record.open);
+        *out++ = ',';
+        out = writeNumber(out, record.high);
+        *out++ = ',';
+        out = writeNumber(out, record.low);
+        *out++ = ',';
+        out = writeNumber(out, record.close);
+        *out++ = ',';
+        out = writeNumber(out, record.balance);
+        *out++ = '\n';
+        return out;
+    }
+
+    char *writeEquityRecord(char *out, const LogRecord &record)
+    {
+        const EquityLog::EquityRecord equity{record.open_time, record.balance};
+        std::memcpy(out, &equity, sizeof(equity));
+        return out + sizeof(equity);
+    }
+}
+
+AsyncLogWriter::AsyncLogWriter(const std::string &path, LogFormat format, const std::string &sourceCsv)
+    : m_File(path, std::ios::out | std::ios::binary | (format == LogFormat::Binary ? std::ios::trunc : std::ios::app)),
+      m_Format(format)
+{
+    if (!m_File.is_open())
+    {
+        std::cerr << "Error: Could not open log file " << path << std::endl;
+        return;
+    }
+    if (m_File.tellp() == 0)
+    {
+        if (m_Format == LogFormat::Binary)
+            m_File << EquityLog::header(sourceCsv);
+        else
+            m_File << "Open time,Open,High,Low,Close,Balance\n";
+    }
+
+    m_Ring = std::make_unique<LogRecord[]>(RING_CAPACITY);
+    m_Writer = std::thread(&AsyncLogWriter::writerLoop, this);
+}
+
+AsyncLogWriter::~AsyncLogWriter()
+{
+    close();
+}
+
+void AsyncLogWriter::close()
+{
+    if (m_Writer.joinable())
+    {
+        {
+            std::lock_guard<std::mutex> lock(m_SleepMutex);
+            m_Stopping.store(true, std::memory_order_release);
+        }
+        m_Ready.notify_one();
+        m_Writer.join();
+    }
+    if (m_File.is_open())
+        m_File.close();
+}
+
+void AsyncLogWriter::waitForSpace()
+{
+    m_Ready.notify_one();
+    std::this_thread::yield();
+}
+
+void AsyncLogWriter::writerLoop()
+{
+    std::unique_ptr<char[]> block = std::make_unique<char[]>(WRITE_BLOCK + MAX_LINE);
+    char *out = block.get();
+    size_t tail = m_Tail.load(std::memory_order_relaxed);
+
+    auto writeBlock = [&]()
+    {
+        m_File.write(block.get(), out - block.get());
+        out = block.get();
+    };
+
+    for (;;)
+    {
+        const size_t head = m_Head.load(std::memory_order_acquire);
+        if (head == tail)
+        {
+            // Stopping is set after the last push, so an empty ring seen after it is final.
+            if (m_Stopping.load(std::memory_order_acquire))
+            {
+                if (m_Head.load(std::memory_order_acquire) != tail)
+                    continue;
+                break;
+            }
+            writeBlock();
+
+            // The producer only notifies once a batch is queued, so idle waits are bounded.
+            std::unique_lock<std::mutex> lock(m_SleepMutex);
+            m_Ready.wait_for(lock, std::chrono::milliseconds(1), [&]()
+                             { return m_Stopping.load(std::memory_order_acquire) ||
+                                      m_Head.load(std::memory_order_acquire) != tail; });
+            continue;
+        }
+
+        const size_t end = (head - tail > FORMAT_BATCH) ? tail + FORMAT_BATCH : head;
+        for (; tail != end; ++tail)
+        {
+            const LogRecord &record = m_Ring[tail & (RING_CAPACITY - 1)];
+            out = (m_Format == LogFormat::Binary) ? writeEquityRecord(out, record) : formatRecord(out, record);
+            if (static_cast<size_t>(out - block.get()) >= WRITE_BLOCK)
+                writeBlock();
+        }
+        m_Tail.store(tail, std::memory_order_release);
+    }
+
+    writeBlock();
+    m_File.flush();
+}
@@ -0,0 +1,219 @@
+#include "CandleCache.hpp"
+#include "MappedFile.hpp"
+
+#include <atomic>
+#include <chrono>
+#include <cstdio>
+#include <cstring>
+#include <filesystem>
+#include <fstream>
+#include <utility>
+#include <unistd.h>
+
+namespace CandleCache {
+    namespace fs = std::filesystem;
+
+    namespace {
+
+        struct SourceInfo
+        {
+            uint64_t size = 0;
+            int64_t mtime = 0;
+        };
+
+        bool statSource(const std::string &csvPath, SourceInfo &info)
+        {
+            std::error_code ec;
+            auto size = fs::file_size(csvPath, ec);
+            if (ec)
+                return false;
+            auto mtime = fs::last_write_time(csvPath, ec);
+            if (ec)
+                return false;
+            info.size = size;
+            info.mtime = std::chrono::duration_cast<std::chrono::nanoseconds>(mtime.time_since_epoch()).count();
+            return true;
+        }
+
+        inline uint64_t rotl(uint64_t x, int r)
+        {
+            return (x << r) | (x >> (64 - r));
+        }
+
+        inline uint64_t alignUp(uint64_t offset)
+        {
+            return (offset + COLUMN_ALIGNMENT - 1) & ~static_cast<uint64_t>(COLUMN_ALIGNMENT - 1);
+        }
+
+        bool headerIsUsable(const CandleCacheHeader &header, size_t fileSize)
+        {
+            if (std::memcmp(header.magic, MAGIC, sizeof(MAGIC)) != 0 ||
+                header.version != VERSION ||
+                header.header_size != sizeof(CandleCacheHeader))
+                return false;
+
+            const uint64_t columnBytes[COLUMN_COUNT] = {sizeof(int64_t), sizeof(float), sizeof(float),
+                                                        sizeof(float), sizeof(float)};
+            for (int c = 0; c < COLUMN_COUNT; ++c)
+            {
+                // Divided rather than multiplied, so a corrupt row count cannot wrap around.
+                if (header.column_offset[c] % COLUMN_ALIGNMENT != 0 ||
+                    header.column_offset[c] > fileSize ||
+                    header.row_count > (fileSize - header.column_offset[c]) / columnBytes[c])
+                    return false;
+            }
+            return true;
+        }
+
+        // Rewrites the header in place, e.g. after the CSV was touched without changing its contents.
+        void rewriteHeader(const std::string &cachePath, const CandleCacheHeader &header)
+        {
+            std::fstream file(cachePath, std::ios::in | std::ios::out | std::ios::binary);
+            if (file.is_open())
+                file.write(reinterpret_cast<const char *>(&header), sizeof(header));
+        }
+
+    }
+
+    std::string cachePathFor(const std::string &csvPath)
+    {
+        return fs::path(csvPath).replace_extension(".candles").string();
+    }
+
+    uint64_t checksum(const char *data, size_t size)
+    {
+        constexpr uint64_t PRIME1 = 0x9E3779B185EBCA87ULL;
+        constexpr uint64_t PRIME2 = 0xC2B2AE3D27D4EB4FULL;
+
+        uint64_t h = PRIME1 ^ (size * PRIME2);
+        size_t i = 0;
+        for (; i + 8 <= size; i += 8)
+        {
+            uint64_t word;
+            std::memcpy(&word, data + i, 8);
+            h ^= rotl(word * PRIME2, 31) * PRIME1;
+            h = rotl(h, 27) * PRIME1 + PRIME2;
+        }
+
+        uint64_t tail = 0;
+        std::memcpy(&tail, data + i, size - i);
+        h ^= rotl(tail * PRIME2, 31) * PRIME1;
+
+        // Final avalanche
+        h ^= h >> 33;
+        h *= PRIME2;
+        h ^= h >> 29;
+        h *= PRIME1;
+        h ^= h >> 32;
+        return h;
+    }
+
+    bool open(const std::string &csvPath, Columns &columns)
+    {
+        SourceInfo source;
+        if (!statSource(csvPath, source))
+            return false;
+
+        const std::string cachePath = cachePathFor(csvPath);
+        MappedFile cache(cachePath);
+        if (!cache.is_open() || cache.size() < sizeof(CandleCacheHeader))
+            return false;
+
+        CandleCacheHeader header;
+        std::memcpy(&header, cache.data(), sizeof(header));
+        if (!headerIsUsable(header, cache.size()) || header.source_size != source.size)
+            return false;
+
+        if (header.source_mtime != source.mtime)
+        {
+            // Touched since the cache was written; only rebuild if the contents changed.
+            MappedFile csv(csvPath);
+            if (!csv.is_open() || checksum(csv.data(), csv.size()) != header.source_checksum)
+                return false;
+            header.source_mtime = source.mtime;
+            rewriteHeader(cachePath, header);
+        }
+
+        const char *base = cache.data();
+        columns.row_count = header.row_count;
+        columns.bar_interval = header.bar_interval;
+        columns.open_time = reinterpret_cast<const int64_t *>(base + header.column_offset[COLUMN_TIME]);
+        columns.open = reinterpret_cast<const float *>(base + header.column_offset[COLUMN_OPEN]);
+        columns.high = reinterpret_cast<const float *>(base + header.column_offset[COLUMN_HIGH]);
+        columns.low = reinterpret_cast<const float *>(base + header.column_offset[COLUMN_LOW]);
+        columns.close = reinterpret_cast<const float *>(base + header.column_offset[COLUMN_CLOSE]);
+        columns.file = std::move(cache);
+        return true;
+    }
+
+    bool write(const std::string &csvPath, const char *csvData, size_t csvSize, const CandleSeries &candles)
+    {
+        SourceInfo source;
+        if (!statSource(csvPath, source) || source.size != csvSize)
+            return false;
+
+        const size_t n = candles.size();
+        const int64_t *time = candles.open_time();
+
+        CandleCacheHeader header{};
+        std::memcpy(header.magic, MAGIC, sizeof(MAGIC));
+        header.version = VERSION;
+        header.header_size = sizeof(CandleCacheHeader);
+        header.row_count = n;
+        header.bar_interval = (n >= 2) ? time[1] - time[0] : 0;
+        header.source_size = source.size;
+        header.source_mtime = source.mtime;
+        header.source_checksum = checksum(csvData, csvSize);
+
+        uint64_t offset = alignUp(sizeof(CandleCacheHeader));
+        header.column_offset[COLUMN_TIME] = offset;
+        offset = alignUp(offset + n * sizeof(int64_t));
+        for (int c = COLUMN_OPEN; c < COLUMN_COUNT; ++c)
+        {
+            header.column_offset[c] = offset;
+            offset = alignUp(offset + n * sizeof(float));
+        }
+
+        // Write to a temporary file and rename so readers never see a partial cache. The name is
+        // unique per write because several runs on the same CSV may rebuild the cache at once.
+        static std::atomic<uint64_t> writeCount{0};
+        const std::string cachePath = cachePathFor(csvPath);
+        const std::string tmpPath = cachePath + ".tmp." + std::to_string(::getpid()) + "." +
+                                    std::to_string(writeCount.fetch_add(1));
+        {
+            std::ofstream out(tmpPath, std::ios::out | std::ios::binary | std::ios::trunc);
+            if (!out.is_open())
+                return false;
+
+            auto writeAt = [&out](uint64_t at, const void *bytes, size_t count)
+            {
+                out.seekp(static_cast<std::streamoff>(at));
+                out.write(static_cast<const char *>(bytes), static_cast<std::streamsize>(count));
+            };
+
+            writeAt(0, &header, sizeof(header));
+            writeAt(header.column_offset[COLUMN_TIME], time, n * sizeof(int64_t));
+            writeAt(header.column_offset[COLUMN_OPEN], candles.open(), n * sizeof(float));
+            writeAt(header.column_offset[COLUMN_HIGH], candles.high(), n * sizeof(float));
+            writeAt(header.column_offset[COLUMN_LOW], candles.low(), n * sizeof(float));
+            writeAt(header.column_offset[COLUMN_CLOSE], candles.close(), n * sizeof(float));
+
+            if (!out.good())
+            {
+                out.close();
+                std::remove(tmpPath.c_str());
+                return false;
+            }
+        }
+
+        std::error_code ec;
+        fs::rename(tmpPath, cachePath, ec);
+        if (ec)
+        {
+            std::remove(tmpPath.c_str());
+            return false;
+        }
+        return true;
+    }
+
+}
@@ -0,0 +1,294 @@
+#include "CandleLoader.hpp"
+#include "CandleCache.hpp"
+#include "HelperFunctions.hpp"
+#include "MappedFile.hpp"
+
+#include <algorithm>
+#include <charconv>
+#include <cstring>
+#include <iostream>
+#include <thread>
+
+namespace CandleLoader {
+
+    namespace {
+
+        // Parses one comma separated float field starting at p and moves p past the delimiter.
+        bool parseField(const char *&p, const char *end, float &value)
+        {
+            auto [ptr, ec] = std::from_chars(p, end, value);
+            if (ec != std::errc() || ptr == p)
+                return false;
+            p = ptr;
+            if (p < end && *p == ',')
+                ++p;
+            return true;
+        }
+
+        // Parses a single data line [p, end) into row. The line must not contain the newline.
+        bool parseLine(const char *p, const char *end, DataRow &row)
+        {
+            const char *comma = static_cast<const char *>(std::memchr(p, ',', end - p));
+            if (comma == nullptr)
+                return false;
+            if (!HelperFunctions::parseTimestamp(p, comma - p, row.open_time))
+                return false;
+            p = comma + 1;
+
+            return parseField(p, end, row.open) &&
+                   parseField(p, end, row.high) &&
+                   parseField(p, end, row.low) &&
+                   parseField(p, end, row.close);
+        }
+
+        // Files smaller than this are parsed on the calling thread.
+        constexpr size_t PARALLEL_PARSE_THRESHOLD = 8u << 20;
+        // Minimum number of bytes handed to each parsing thread.
+        constexpr size_t MIN_CHUNK_BYTES = 4u << 20;
+
+        // What a parse saw besides the rows it emitted.
+        struct LineStats
+        {
+            size_t malformed = 0;
+            size_t firstBlankLine = SIZE_MAX;
+            size_t lastRowLine = 0; // last line holding a row, malformed or not
+
+            void merge(const LineStats &other)
+            {
+                malformed += other.malformed;
+                firstBlankLine = std::min(firstBlankLine, other.firstBlankLine);
+                lastRowLine = std::max(lastRowLine, other.lastRowLine);
+            }
+
+            // True if row i is on line i + 2: no malformed rows and no blank lines before the last row.
+            bool rowsOnConsecutiveLines() const { return malformed == 0 && firstBlankLine > lastRowLine; }
+        };
+
+        // Parses every line of [p, end), numbering lines from firstLine, and hands rows to emit.
+        template <typename Emit>
+        void parseLines(const char *p, const char *end, size_t firstLine, const std::string &filename,
+                        TimestampValidator &validator, LineStats &stats, Emit &&emit)
+        {
+            size_t lineNumber = firstLine;
+            while (p < end)
+            {
+                const char *nl = static_cast<const char *>(std::memchr(p, '\n', end - p));
+                const char *lineEnd = (nl != nullptr) ? nl : end;
+                const char *next = (nl != nullptr) ? nl + 1 : end;
+                if (lineEnd > p && lineEnd[-1] == '\r')
+                    --lineEnd;
+
+                if (lineEnd == p)
+                {
+                    stats.firstBlankLine = std::min(stats.firstBlankLine, lineNumber);
+                }
+                else
+                {
+                    stats.lastRowLine = lineNumber;
+                    DataRow row;
+                    if (parseLine(p, lineEnd, row))
+                    {
+                        validator.check(lineNumber, row.open_time);
+                        emit(row, lineNumber);
+                    }
+                    else
+                    {
+                        std::cerr << "Error: Malformed row at line " << lineNumber << " in " << filename << std::endl;
+                        validator.malformed(lineNumber);
+                        ++stats.malformed;
+                    }
+                }
+
+                p = next;
+                ++lineNumber;
+            }
+        }
+
+        struct ParseChunk
+        {
+            const char *begin = nullptr;
+            const char *end = nullptr;
+            size_t lines = 0;      // upper bound of rows, i.e. the slots reserved in the output
+            size_t firstLine = 0;
+            size_t offset = 0;     // first output slot
+            size_t rows = 0;       // rows actually parsed
+            LineStats stats;
+            int64_t firstTime = 0;
+            int64_t lastTime = 0;
+            size_t firstRowLine = 0; // line of the first parsed row
+            ValidationReport report;
+        };
+
+        // Splits [p, end) into newline aligned chunks, parses them on all cores directly into their
+        // slice of a pre-sized buffer and stitches the chunks back together in file order.
+        CandleSeries parseParallel(const char *p, const char *end, const std::string &filename,
+                                           TimestampValidator &validator, LineStats &stats,
+                                           size_t threadCount)
+        {
+            std::vector<ParseChunk> chunks(threadCount);
+            const size_t chunkBytes = static_cast<size_t>(end - p) / threadCount;
+            const char *cursor = p;
+            for (size_t k = 0; k < threadCount; ++k)
+            {
+                const char *chunkEnd = end;
+                if (k + 1 < threadCount)
+                {
+                    const char *target = std::max(cursor, p + (k + 1) * chunkBytes);
+                    const char *nl = static_cast<const char *>(std::memchr(target, '\n', end - target));
+                    chunkEnd = (nl != nullptr) ? nl + 1 : end;
+                }
+                chunks[k].begin = cursor;
+                chunks[k].end = chunkEnd;
+                cursor = chunkEnd;
+            }
+
+            auto runAll = [&chunks](auto &&work)
+            {
+                std::vector<std::thread> threads;
+                threads.reserve(chunks.size());
+                for (ParseChunk &chunk : chunks)
+                    threads.emplace_back([&work, &chunk]() { work(chunk); });
+                for (std::thread &thread : threads)
+                    thread.join();
+            };
+
+            // Pass 1: count lines so every chunk knows its line numbers and output slots.
+            runAll([](ParseChunk &chunk)
+                   {
+                       chunk.lines = std::count(chunk.begin, chunk.end, '\n');
+                       if (chunk.end > chunk.begin && chunk.end[-1] != '\n')
+                           ++chunk.lines; });
+
+            size_t totalLines = 0;
+            for (ParseChunk &chunk : chunks)
+            {
+                chunk.firstLine = 2 + totalLines;
+                chunk.offset = totalLines;
+                totalLines += chunk.lines;
+            }
+
+            // Pass 2: parse in place. Each chunk validates its own rows; the first row of a chunk
+            // is checked against the previous chunk while stitching.
+            CandleSeries data(totalLines);
+            const bool validating = validator.enabled();
+            const int64_t interval = validator.interval();
+            runAll([&data, &filename, validating, interval](ParseChunk &chunk)
+                   {
+                       TimestampValidator local(validating ? &chunk.report : nullptr, interval);
+                       parseLines(chunk.begin, chunk.end, chunk.firstLine, filename, local, chunk.stats,
+                                  [&chunk, &data](const DataRow &row, size_t line)
+                                  {
+                                      if (chunk.rows == 0)
+                                      {
+                                          chunk.firstTime = row.open_time;
+                                          chunk.firstRowLine = line;
+                                      }
+                                      chunk.lastTime = row.open_time;
+                                      data.set(chunk.offset + chunk.rows++, row);
+                                  }); });
+
+            size_t written = 0;
+            for (ParseChunk &chunk : chunks)
+            {
+                if (chunk.offset != written)
+                    data.moveRows(chunk.offset, written, chunk.rows);
+                written += chunk.rows;
+                stats.merge(chunk.stats);
+                validator.merge(chunk.report, chunk.rows, chunk.firstRowLine, chunk.firstTime, chunk.lastTime);
+            }
+            data.resize(written);
+            return data;
+        }
+
+        CandleSeries parseCSV(const char *p, const char *end, const std::string &filename,
+                                      TimestampValidator &validator, LineStats &stats)
+        {
+            CandleSeries data;
+            if (p == end)
+                return data;
+
+            // Skip the header line
+            const char *nl = static_cast<const char *>(std::memchr(p, '\n', end - p));
+            if (nl == nullptr)
+                return data;
+            p = nl + 1;
+
+            const size_t bytes = static_cast<size_t>(end - p);
+            const size_t threadCount = std::min<size_t>(std::max(1u, std::thread::hardware_concurrency()),
+                                                        bytes / MIN_CHUNK_BYTES);
+            if (bytes >= PARALLEL_PARSE_THRESHOLD && threadCount > 1)
+                return parseParallel(p, end, filename, validator, stats, threadCount);
+
+            // Pre-size from the file length using the first data line as the row width estimate.
+            nl = static_cast<const char *>(std::memchr(p, '\n', end - p));
+            size_t firstLineLength = (nl != nullptr ? nl - p : end - p) + 1;
+            data.reserve(bytes / firstLineLength + 1);
+
+            parseLines(p, end, 2, filename, validator, stats,
+                       [&data](const DataRow &row, size_t) { data.push_back(row); });
+            return data;
+        }
+
+        CandleSeries materialize(const CandleCache::Columns &columns, TimestampValidator &validator)
+        {
+            const size_t n = columns.row_count;
+            CandleSeries data(n);
+            std::memcpy(data.open(), columns.open, n * sizeof(float));
+            std::memcpy(data.high(), columns.high, n * sizeof(float));
+            std::memcpy(data.low(), columns.low, n * sizeof(float));
+            std::memcpy(data.close(), columns.close, n * sizeof(float));
+
+            int64_t *time = data.open_time();
+            for (size_t i = 0; i < n; ++i)
+            {
+                time[i] = columns.open_time[i];
+                // The cache is only written for files whose row i is on line i + 2 (see LineStats).
+                validator.check(i + 2, time[i]);
+            }
+            return data;
+        }
+
+        CandleSeries loadValidated(const std::string &filename, TimestampValidator &validator)
+        {
+            CandleCache::Columns columns;
+            if (CandleCache::open(filename, columns))
+            {
+                validator.opened();
+                return materialize(columns, validator);
+            }
+
+            MappedFile file(filename);
+            if (!file.is_open())
+            {
+                std::cerr << "Error: Could not open the file!" << std::endl;
+                return {};
+            }
+            validator.opened();
+
+            LineStats stats;
+            CandleSeries data = parseCSV(file.data(), file.data() + file.size(), filename,
+                                                 validator, stats);
+
+            // Files with malformed rows are not cached so the problem is reported again on the next run;
+            // neither are files with blank lines between rows, whose line numbers the cache cannot restore.
+            if (!data.empty() && stats.rowsOnConsecutiveLines() &&
+                !CandleCache::write(filename, file.data(), file.size(), data))
+                std::cerr << "Warning: Could not write candle cache for " << filename << std::endl;
+            return data;
+        }
+
+    }
+
+    CandleSeries load(const std::string &filename)
+    {
+        TimestampValidator noValidation(nullptr, 0);
+        return loadValidated(filename, noValidation);
+    }
+
+    CandleSeries load(const std::string &filename, int64_t intervalSeconds, ValidationReport &report)
+    {
+        TimestampValidator validator(&report, intervalSeconds);
+        return loadValidated(filename, validator);
+    }
+
+}
@@ -0,0 +1,81 @@
+#include "DonchianChannels.hpp"
+
+#include <algorithm>
+#include <bit>
+
+DonchianChannels::DonchianChannels(const CandleSeries &series, const std::vector<int> &sensitivities)
+{
+    m_Channels.reserve(sensitivities.size());
+    for (int sensitivity : sensitivities)
+    {
+        if (find(sensitivity) == nullptr)
+            m_Channels.push_back(build(series.close(), series.size(), sensitivity));
+    }
+}
+
+const DonchianChannel *DonchianChannels::find(int sensitivity) const
+{
+    for (const DonchianChannel &channel : m_Channels)
+    {
+        if (channel.sensitivity == sensitivity)
+            return &channel;
+    }
+    return nullptr;
+}
+
+DonchianChannel DonchianChannels::build(const float *close, size_t count, int sensitivity)
+{
+    DonchianChannel channel;
+    channel.sensitivity = sensitivity;
+    channel.high.assign(count, 0.0f);
+    channel.low.assign(count, 0.0f);
+    channel.breakouts.assign((count + 63) / 64, 0);
+
+    const size_t w = static_cast<size_t>(sensitivity);
+    if (w == 0 || count <= w)
+        return channel;
+
+    // Split the series into blocks of w bars. prefix* runs from the start of a block to j,
+    // suffix* from j to the end of its block. Any window of w bars spans at most two blocks,
+    // so its extremum is the combination of one suffix and one prefix value.
+    std::vector<float> prefixMax(count), prefixMin(count), suffixMax(count), suffixMin(count);
+    for (size_t j = 0; j < count; ++j)
+    {
+        bool blockStart = (j % w == 0);
+        prefixMax[j] = blockStart ? close[j] : std::max(prefixMax[j - 1], close[j]);
+        prefixMin[j] = blockStart ? close[j] : std::min(prefixMin[j - 1], close[j]);
+    }
+    for (size_t j = count; j-- > 0;)
+    {
+        bool blockEnd = (j + 1 == count) || ((j + 1) % w == 0);
+        suffixMax[j] = blockEnd ? close[j] : std::max(suffixMax[j + 1], close[j]);
+        suffixMin[j] = blockEnd ? close[j] : std::min(suffixMin[j + 1], close[j]);
+    }
+
+    // Bar i sees the window [i - w, i - 1].
+    for (size_t i = w; i < count; ++i)
+    {
+        channel.high[i] = std::max(suffixMax[i - w], prefixMax[i - 1]);
+        channel.low[i] = std::min(suffixMin[i - w], prefixMin[i - 1]);
+        if (close[i] > channel.high[i] || close[i] < channel.low[i])
+            channel.breakouts[i / 64] |= uint64_t(1) << (i % 64);
+    }
+    return channel;
+}
+
+size_t DonchianChannel::nextBreakout(size_t from, size_t end) const
+{
+    end = std::min(end, high.size());
+    if (from >= end)
+        return end;
+
+    size_t word = from / 64;
+    uint64_t bits = breakouts[word] & (~uint64_t(0) << (from % 64));
+    while (bits == 0)
+    {
+        if (++word * 64 >= end)
+            return end;
+        bits = breakouts[word];
+    }
+    return std::min(word * 64 + std::countr_zero(bits), end);
+}
@@ -0,0 +1,46 @@
+#include "EquityLog.hpp"
+
+#include <cstring>
+#include <utility>
+
+namespace EquityLog {
+
+    std::string header(const std::string &sourceCsv)
+    {
+        EquityLogHeader fixed{};
+        std::memcpy(fixed.magic, MAGIC, sizeof(MAGIC));
+        fixed.version = VERSION;
+        fixed.record_size = sizeof(EquityRecord);
+        fixed.source_length = static_cast<uint32_t>(sourceCsv.size());
+        const size_t used = sizeof(EquityLogHeader) + sourceCsv.size();
+        fixed.header_size = static_cast<uint32_t>((used + HEADER_ALIGNMENT - 1) / HEADER_ALIGNMENT * HEADER_ALIGNMENT);
+
+        std::string bytes(fixed.header_size, '\0');
+        std::memcpy(&bytes[0], &fixed, sizeof(fixed));
+        std::memcpy(&bytes[sizeof(fixed)], sourceCsv.data(), sourceCsv.size());
+        return bytes;
+    }
+
+    bool open(const std::string &path, Curve &curve)
+    {
+        MappedFile file(path);
+        if (!file.is_open() || file.size() < sizeof(EquityLogHeader))
+            return false;
+
+        EquityLogHeader fixed;
+        std::memcpy(&fixed, file.data(), sizeof(fixed));
+        if (std::memcmp(fixed.magic, MAGIC, sizeof(MAGIC)) != 0 || fixed.version != VERSION ||
+            fixed.record_size != sizeof(EquityRecord) || fixed.header_size % HEADER_ALIGNMENT != 0 ||
+            sizeof(EquityLogHeader) + fixed.source_length > fixed.header_size ||
+            fixed.header_size > file.size())
+            return false;
+
+        curve.source_csv.assign(file.data() + sizeof(EquityLogHeader), fixed.source_length);
+        // A run cut short may leave a partial record at the end; it is ignored.
+        curve.row_count = (file.size() - fixed.header_size) / sizeof(EquityRecord);
+        curve.records = reinterpret_cast<const EquityRecord *>(file.data() + fixed.header_size);
+        curve.file = std::move(file);
+        return true;
+    }
+
+}
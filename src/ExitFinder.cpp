@@ -0,0 +1,59 @@
+#include "ExitFinder.hpp"
+
+#include <algorithm>
+
+namespace {
+    constexpr size_t GROUP = ExitFinder::BLOCK * ExitFinder::BLOCK;
+
+    // Max / min of each run of `width` values (the last run may be shorter).
+    void summarize(const float *high, const float *low, size_t count, size_t width,
+                   std::vector<float> &runHigh, std::vector<float> &runLow)
+    {
+        size_t runs = (count + width - 1) / width;
+        runHigh.resize(runs);
+        runLow.resize(runs);
+        for (size_t r = 0; r < runs; ++r)
+        {
+            size_t begin = r * width;
+            size_t end = std::min(begin + width, count);
+            runHigh[r] = *std::max_element(high + begin, high + end);
+            runLow[r] = *std::min_element(low + begin, low + end);
+        }
+    }
+
+    inline bool hits(float high, float low, double upper, double lower)
+    {
+        return high >= upper || low <= lower;
+    }
+}
+
+ExitFinder::ExitFinder(const CandleSeries &series)
+    : m_High(series.high()), m_Low(series.low()), m_Size(series.size())
+{
+    summarize(m_High, m_Low, m_Size, BLOCK, m_BlockHigh, m_BlockLow);
+    summarize(m_BlockHigh.data(), m_BlockLow.data(), m_BlockHigh.size(), BLOCK, m_GroupHigh, m_GroupLow);
+}
+
+size_t ExitFinder::find(size_t from, size_t end, double upper, double lower) const
+{
+    end = std::min(end, m_Size);
+    size_t i = from;
+    while (i < end)
+    {
+        // Skip whole groups and blocks that cannot hit; step into them bar by bar otherwise.
+        if (i % GROUP == 0 && i + GROUP <= end && !hits(m_GroupHigh[i / GROUP], m_GroupLow[i / GROUP], upper, lower))
+        {
+            i += GROUP;
+            continue;
+        }
+        if (i % BLOCK == 0 && i + BLOCK <= end && !hits(m_BlockHigh[i / BLOCK], m_BlockLow[i / BLOCK], upper, lower))
+        {
+            i += BLOCK;
+            continue;
+        }
+        if (hits(m_High[i], m_Low[i], upper, lower))
+            return i;
+        ++i;
+    }
+    return end;
+}
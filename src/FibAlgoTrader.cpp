@@ -1,104 +1,112 @@
 #include "FibAlgoTrader.hpp"
 #include "HelperFunctions.hpp"
+#include "CandleLoader.hpp"
+#include "ResultsSink.hpp"
+#include "SimulationKernel.hpp"
 #include <csignal>
 #include <atomic>
-
-std::vector<DataRow> FibAlgoTrader::readCSV(const std::string &filename)
-{
-    std::vector<DataRow> data;
-    std::ifstream file(filename);
-    if (!file.is_open())
+#include <cstring>
+#include <list>
+#include <memory>
+#include <numeric>
+#include <optional>
+
+namespace {
+    // Start of the window after the one starting at startIndex if (sensitivity, tpsl) wins its
+    // optimization: the apply phase of performRollingWindowOptimization without logging or sizing.
+    size_t nextWindowStart(const CandleSeries &allData, const DonchianChannels &channels,
+                           const ExitFinder &exits, size_t startIndex, int sensitivity, float tpsl,
+                           size_t applyTrades)
     {
-        std::cerr << "Error: Could not open the file!" << std::endl;
-        return data;
-    }
-
-    std::string line;
-    std::getline(file, line); // Skip the header line
+        CandleView applyView(allData, startIndex - sensitivity, allData.size());
+        int wins = 0;
+        int losses = 0;
+        float volume = 0.0f;
+        TradeSimulationParams applyParams(applyView, sensitivity, tpsl, wins, losses, 1.0f, sensitivity,
+                                          applyTrades, 1000.0f, 1000.0f, 1000.0f, 0, volume);
+        if (const DonchianChannel *channel = channels.find(sensitivity))
+        {
+            applyParams.channel_high = channel->high.data() + applyView.offset();
+            applyParams.channel_low = channel->low.data() + applyView.offset();
+            applyParams.breakouts = channel;
+        }
+        applyParams.exits = &exits;
 
-    while (std::getline(file, line))
-    {
-        std::stringstream ss(line);
-        DataRow row;
-        std::string temp;
-
-        std::getline(ss, row.open_time, ',');
-        std::getline(ss, temp, ',');
-        row.open = std::stof(temp);
-        std::getline(ss, temp, ',');
-        row.high = std::stof(temp);
-        std::getline(ss, temp, ',');
-        row.low = std::stof(temp);
-        std::getline(ss, temp, ',');
-        row.close = std::stof(temp);
-
-        data.push_back(row);
+        SimulationKernel::NullObserver observer;
+        TradeSimulationResult result =
+            SimulationKernel::run<SimulationKernel::ResetToFirstBalance, SimulationKernel::TakeProfitFirst>(applyParams, observer);
+        return startIndex + (result.last_index - sensitivity);
     }
+}
 
-    file.close();
-    return data;
+CandleSeries FibAlgoTrader::readCSV(const std::string &filename)
+{
+    return CandleLoader::load(filename);
 }
 
-ResultHighBroke FibAlgoTrader::optimizeParameters(const std::vector<DataRow> &data,
+ResultHighBroke FibAlgoTrader::optimizeParameters(const CandleView &data,
                                                   const OptimizationParams &params,
-                                                  float initialTradeSize)
+                                                  float initialTradeSize,
+                                                  const DonchianChannels *channels,
+                                                  const ExitFinder *exits)
 {
-    size_t totalPairs = params.sensitivity_values.size() * params.tpsl_values.size();
+    const size_t tpslCount = params.tpsl_values.size();
+    size_t totalPairs = params.sensitivity_values.size() * tpslCount;
     std::vector<ResultHighBroke> localResults(totalPairs);
-    std::vector<std::thread> threads;
-    size_t index = 0;
+    // Nested in whatever task calls us: waiting on the group runs its batches no worker has started.
+    TaskGroup batches(m_Pool);
 
-    // Loop over each combination of sensitivity and tpsl
-    for (int sensitivity : params.sensitivity_values)
+    // For each sensitivity, simulate the tpsl values in batches of TPSL_LANES: every tpsl value sees
+    // the same breakout signals, so one vectorized pass covers the whole batch.
+    for (size_t s = 0; s < params.sensitivity_values.size(); ++s)
     {
-        for (float tpsl : params.tpsl_values)
+        const int sensitivity = params.sensitivity_values[s];
+        const DonchianChannel *channel = (channels != nullptr) ? channels->find(sensitivity) : nullptr;
+
+        for (size_t firstTpsl = 0; firstTpsl < tpslCount; firstTpsl += TPSL_LANES)
         {
-            // Capture the current index by value.
-            size_t localIndex = index;
-            threads.emplace_back([this, &data, sensitivity, tpsl, initialTradeSize, &localResults, localIndex]()
-                                 {
-                // Create local counters that will be updated via the reference parameters.
-                int wins = 0;
-                int losses = 0;
-                float tradedVolume = 0.0f;
-                // Create a local copy of the data since TradeSimulationParams expects a non-const reference.
-                std::vector<DataRow> localData = data;
-
-                // Construct the simulation parameters using the required 12 arguments.
-                TradeSimulationParams simParams(
-                    localData,           // data reference
-                    sensitivity,         // sensitivity
-                    tpsl,                // tpsl
-                    wins,                // total_wins (reference)
-                    losses,              // total_losses (reference)
-                    1.0f,                // multiplier (adjust as needed)
-                    0,                   // start_index (beginning of localData)
-                    999999,              // max_trades (large number for optimization)
-                    initialTradeSize,    // initial_trade_size
-                    1000.0f,             // starting_state_balance
-                    1000.0f,             // first balance
-                    0,                   // trading_count (if used)
-                    tradedVolume         // total_traded_volume (reference)
-                );
-
-                // Run simulation for this parameter combination
-                TradeSimulationResult simResult = this->simulateTradesOptimizing(simParams);
-
-                // Use the local wins/losses counters (updated by reference) rather than simResult members.
-                int totalTrades = wins + losses;
-                float winRate = (totalTrades > 0) ? static_cast<float>(wins) / totalTrades : 0.0f;
-
-                // Use an explicit constructor (or brace initialization) for ResultHighBroke.
-                localResults[localIndex] = ResultHighBroke{ simResult.final_balance, sensitivity, tpsl, wins, losses, winRate }; });
-            ++index;
+            // Index of the first result of this batch in localResults.
+            size_t localIndex = s * tpslCount + firstTpsl;
+            size_t laneCount = std::min(TPSL_LANES, tpslCount - firstTpsl);
+            batches.run([this, data, channel, exits, sensitivity, &params, firstTpsl, laneCount,
+                          initialTradeSize, &localResults, localIndex]()
+                         {
+                // All workers read the same candles through their own copy of the view.
+                TradeSimulationBatchParams simParams(data, sensitivity);
+                for (size_t l = 0; l < laneCount; ++l)
+                    simParams.tpsl[l] = params.tpsl_values[firstTpsl + l];
+                simParams.lane_count = laneCount;
+                simParams.multiplier = 1.0f;
+                simParams.start_index = 0;          // beginning of the view
+                simParams.max_trades = 999999;      // large number for optimization
+                simParams.initial_trade_size = initialTradeSize;
+                simParams.starting_state_balance = 1000.0f;
+                if (channel != nullptr)
+                {
+                    // The channel covers the whole series; shift it to the start of the view.
+                    simParams.channel_high = channel->high.data() + data.offset();
+                    simParams.channel_low = channel->low.data() + data.offset();
+                    simParams.breakouts = channel;
+                }
+                simParams.exits = exits;
+
+                // Run the simulation for all tpsl values of this batch
+                TradeSimulationBatchResult simResult = this->simulateTradesOptimizingBatch(simParams);
+
+                for (size_t l = 0; l < laneCount; ++l)
+                {
+                    int wins = simResult.wins[l];
+                    int losses = simResult.losses[l];
+                    int totalTrades = wins + losses;
+                    float winRate = (totalTrades > 0) ? static_cast<float>(wins) / totalTrades : 0.0f;
+                    localResults[localIndex + l] = ResultHighBroke{ simResult.final_balance[l], sensitivity,
+                                                                    simParams.tpsl[l], wins, losses, winRate };
+                } });
         }
     }
 
-    // Wait for all threads to complete
-    for (auto &thread : threads)
-    {
-        thread.join();
-    }
+    // Wait for all batches to complete
+    batches.wait();
 
     // Find and return the best parameter combination based on win rate
     ResultHighBroke bestResult{};
@@ -112,254 +120,320 @@ ResultHighBroke FibAlgoTrader::optimizeParameters(const std::vector<DataRow> &da
 
 TradeSimulationResult FibAlgoTrader::simulateTradesOptimizing(TradeSimulationParams &params)
 {
+    SimulationKernel::NullObserver observer;
+    TradeSimulationResult result =
+        SimulationKernel::run<SimulationKernel::ResetToInitialSize, SimulationKernel::TakeProfitFirst>(params, observer);
 
-    const size_t dataSize = params.data.size();
-    TradingState state;
-    state.balance = params.starting_state_balance;
-    float nextAmount = params.initial_trade_size;
-    size_t tradesMade = 0;
-    size_t i = params.start_index;
-    const int waitCounterConst = 5;
-    int localWaitCounter = waitCounterConst;
+    // Reported relative to the start of the simulation, one before the bar the loop stopped at.
+    result.last_index = params.start_index + result.last_index - 1;
+    return result;
+}
 
-    for (; i < dataSize && tradesMade < params.max_trades; ++i)
+namespace {
+    // Doubles per SIMD register of the compile target. The batch kernel keeps its lane state in plain
+    // arrays and checks them one register at a time, so wider targets (ENABLE_NATIVE_ARCH) simply take
+    // fewer steps per bar. Comparisons of these GCC/Clang vector types yield -1/0 lane masks.
+#if defined(__AVX512F__)
+    constexpr size_t VECTOR_DOUBLES = 8;
+#elif defined(__AVX__)
+    constexpr size_t VECTOR_DOUBLES = 4;
+#else
+    constexpr size_t VECTOR_DOUBLES = 2;
+#endif
+    static_assert(TPSL_LANES % VECTOR_DOUBLES == 0, "TPSL_LANES must be a multiple of the vector width");
+
+    typedef double VecF64 __attribute__((vector_size(VECTOR_DOUBLES * sizeof(double))));
+    typedef int64_t VecMask __attribute__((vector_size(VECTOR_DOUBLES * sizeof(int64_t))));
+
+    inline VecF64 loadLanes(const double *src)
     {
-        if (localWaitCounter > 0)
-        {
-            localWaitCounter--;
-            continue;
-        }
-
-        if (i >= static_cast<size_t>(params.sensitivity))
-        {
-            float high = params.data[i - params.sensitivity].close;
-            float low = params.data[i - params.sensitivity].close;
-            for (size_t j = i - params.sensitivity; j < i; ++j)
-            {
-                high = std::max(high, params.data[j].close);
-                low = std::min(low, params.data[j].close);
-            }
-            bool longCondition = (params.data[i].close > high);
-            bool shortCondition = (params.data[i].close < low);
-
-            if (!state.in_position)
-            {
-                if (longCondition)
-                {
-                    state.in_position = true;
-                    state.position_type = "Long";
-                    state.entry_price = params.data[i].close;
-                    state.position_size = nextAmount / state.entry_price;
-                    state.tp_price = state.entry_price * (1.0f + params.tpsl);
-                    state.sl_price = state.entry_price * (1.0f - params.tpsl);
-                    params.total_traded_volume += nextAmount;
-                }
-                else if (shortCondition)
-                {
-                    state.in_position = true;
-                    state.position_type = "Short";
-                    state.entry_price = params.data[i].close;
-                    state.position_size = nextAmount / state.entry_price;
-                    state.tp_price = state.entry_price * (1.0f - params.tpsl);
-                    state.sl_price = state.entry_price * (1.0f + params.tpsl);
-                    params.total_traded_volume += nextAmount;
-                }
-            }
-            else
-            {
-                if (state.position_type == "Long")
-                {
-                    if (params.data[i].high >= state.tp_price)
-                    {
-                        double profit = state.position_size * (state.tp_price - state.entry_price);
-                        state.balance += profit;
-                        params.total_wins++;
-                        state.in_position = false;
-                        nextAmount = params.initial_trade_size;
-                        tradesMade++;
-                        localWaitCounter = waitCounterConst;
-                    }
-                    else if (params.data[i].low <= state.sl_price)
-                    {
-                        double loss = state.position_size * (state.entry_price - state.sl_price);
-                        state.balance -= loss;
-                        params.total_losses++;
-                        state.in_position = false;
-                        nextAmount *= params.multiplier;
-                        tradesMade++;
-                        localWaitCounter = waitCounterConst;
-                    }
-                }
-                else if (state.position_type == "Short")
-                {
-                    if (params.data[i].low <= state.tp_price)
-                    {
-                        double profit = state.position_size * (state.entry_price - state.tp_price);
-                        state.balance += profit;
-                        params.total_wins++;
-                        state.in_position = false;
-                        nextAmount = params.initial_trade_size;
-                        tradesMade++;
-                        localWaitCounter = waitCounterConst;
-                    }
-                    else if (params.data[i].high >= state.sl_price)
-                    {
-                        double loss = state.position_size * (state.sl_price - state.entry_price);
-                        state.balance -= loss;
-                        params.total_losses++;
-                        state.in_position = false;
-                        nextAmount *= params.multiplier;
-                        tradesMade++;
-                        localWaitCounter = waitCounterConst;
-                    }
-                }
-            }
-        }
+        VecF64 v;
+        std::memcpy(&v, src, sizeof(v));
+        return v;
     }
 
-    return TradeSimulationResult{state.balance, params.start_index + i - 1, nextAmount};
+    inline void storeLanes(double *dst, VecF64 v)
+    {
+        std::memcpy(dst, &v, sizeof(v));
+    }
 }
 
-TradeSimulationResult FibAlgoTrader::simulateTradesApplying(TradeSimulationParams &params)
+TradeSimulationBatchResult FibAlgoTrader::simulateTradesOptimizingBatch(const TradeSimulationBatchParams &params)
 {
-    std::ofstream logFile;
-
-    logFile.open(params.logFileName, std::ios::out | std::ios::app);
-    if (logFile.tellp() == 0)
+    constexpr size_t L = TPSL_LANES;
+    const size_t dataSize = params.data.size();
+    const float *closes = params.data.close();
+    const float *highs = params.data.high();
+    const float *lows = params.data.low();
+    const double waitCounterConst = 5;
+    // Lanes past lane_count are only swept up to the end of their vector.
+    const size_t usedLanes = (std::min(params.lane_count, L) + VECTOR_DOUBLES - 1) / VECTOR_DOUBLES * VECTOR_DOUBLES;
+
+    // Per-lane state of simulateTradesOptimizing, one tpsl value per lane. Direction is 1 long, -1 short
+    // and 0 flat. A lane that is unused or has made max_trades waits forever, so it never raises an event.
+    alignas(64) double direction[L] = {};
+    alignas(64) double waitCounter[L];
+    alignas(64) double tpPrice[L] = {};
+    alignas(64) double slPrice[L] = {};
+    double entryPrice[L] = {};
+    double positionSize[L] = {};
+    double balance[L];
+    float nextAmount[L];
+    float volume[L] = {};
+    int wins[L] = {};
+    int losses[L] = {};
+    size_t tradesMade[L] = {};
+    size_t exitBar[L] = {};
+    size_t activeLanes = 0;
+    for (size_t l = 0; l < L; ++l)
     {
-        logFile << "Open time,Open,High,Low,Close,Balance\n";
+        const bool active = (l < params.lane_count && params.max_trades > 0);
+        waitCounter[l] = active ? waitCounterConst : INFINITY;
+        balance[l] = params.starting_state_balance;
+        nextAmount[l] = params.initial_trade_size;
+        activeLanes += active;
     }
 
-    const size_t dataSize = params.data.size();
-    TradingState state;
-    state.balance = params.starting_state_balance;
-    float nextAmount = params.initial_trade_size;
-    size_t tradesMade = 0;
+    const size_t sensitivity = static_cast<size_t>(params.sensitivity);
+    const float *channelHigh = params.channel_high;
+    const float *channelLow = params.channel_low;
+    const bool trackChannel = (channelHigh == nullptr || channelLow == nullptr);
     size_t i = params.start_index;
-    const int waitCounterConst = 5;
-    int localWaitCounter = waitCounterConst;
-    float returned_balance = params.first_balance;
-
-    for (; i < dataSize && tradesMade < params.max_trades; ++i)
+    RollingMinMax channel(trackChannel ? sensitivity : 0);
+    for (size_t j = (i > sensitivity ? i - sensitivity : 0); trackChannel && j < i; ++j)
+        channel.push(j, closes[j]);
+    // Jumping to exits and breakouts needs the precomputed channel; the rolling one must see every bar.
+    const bool skipAhead = (params.exits != nullptr && !trackChannel);
+    const bool skipFlat = (params.breakouts != nullptr && !trackChannel);
+
+    for (; i < dataSize && activeLanes > 0; ++i)
     {
-        if (logFile.is_open())
+        if (trackChannel && i > params.start_index)
+            channel.push(i - 1, closes[i - 1]);
+
+        // Breakout signals are shared by all lanes; a zero-width channel never breaks out.
+        const bool evaluate = (sensitivity > 0 && i >= sensitivity);
+        bool longCondition = false;
+        bool shortCondition = false;
+        if (evaluate)
         {
-            const DataRow &row = params.data[i];
-            logFile << row.open_time << "," << row.open << ","
-                    << row.high << "," << row.low << ","
-                    << row.close << "," << state.balance << "\n";
+            float high = trackChannel ? channel.max() : channelHigh[i];
+            float low = trackChannel ? channel.min() : channelLow[i];
+            longCondition = (closes[i] > high);
+            shortCondition = (closes[i] < low);
         }
 
-        if (localWaitCounter > 0)
+        // Vector pass: count down the wait counters and flag the lanes that enter or exit on this bar.
+        const VecF64 barHigh = VecF64{} + static_cast<double>(highs[i]);
+        const VecF64 barLow = VecF64{} + static_cast<double>(lows[i]);
+        const VecMask signal = VecMask{} + ((longCondition || shortCondition) ? -1 : 0);
+        alignas(64) int64_t event[L];
+        VecMask anyEvent = {};
+        for (size_t c = 0; c < usedLanes; c += VECTOR_DOUBLES)
         {
-            localWaitCounter--;
-            continue;
+            const VecF64 wait = loadLanes(waitCounter + c);
+            const VecMask waiting = (wait > 0.0);
+            storeLanes(waitCounter + c, waiting ? wait - 1.0 : wait);
+
+            const VecF64 dir = loadLanes(direction + c);
+            const VecF64 tp = loadLanes(tpPrice + c);
+            const VecF64 sl = loadLanes(slPrice + c);
+            const VecMask longExit = (dir > 0.0) & ((barHigh >= tp) | (barLow <= sl));
+            const VecMask shortExit = (dir < 0.0) & ((barLow <= tp) | (barHigh >= sl));
+            const VecMask entry = (dir == 0.0) & signal;
+            const VecMask hit = ~waiting & (longExit | shortExit | entry);
+            std::memcpy(event + c, &hit, sizeof(hit));
+            anyEvent |= hit;
         }
 
-        if (i >= static_cast<size_t>(params.sensitivity))
+        int64_t any = 0;
+        for (size_t c = 0; c < VECTOR_DOUBLES; ++c)
+            any |= anyEvent[c];
+        const bool events = (evaluate && any);
+
+        // Scalar pass over the flagged lanes, with the arithmetic of simulateTradesOptimizing.
+        for (size_t l = 0; events && l < usedLanes; ++l)
         {
-            float high = params.data[i - params.sensitivity].close;
-            float low = params.data[i - params.sensitivity].close;
-            for (size_t j = i - params.sensitivity; j < i; ++j)
-            {
-                high = std::max(high, params.data[j].close);
-                low = std::min(low, params.data[j].close);
-            }
-            bool longCondition = (params.data[i].close > high);
-            bool shortCondition = (params.data[i].close < low);
+            if (!event[l])
+                continue;
 
-            if (!state.in_position)
+            const float tpsl = params.tpsl[l];
+            bool closed = false;
+            if (direction[l] == 0.0)
             {
+                entryPrice[l] = closes[i];
+                positionSize[l] = nextAmount[l] / entryPrice[l];
                 if (longCondition)
                 {
-                    state.in_position = true;
-                    state.position_type = "Long";
-                    state.entry_price = params.data[i].close;
-                    state.position_size = nextAmount / state.entry_price;
-                    state.tp_price = state.entry_price * (1.0f + params.tpsl);
-                    state.sl_price = state.entry_price * (1.0f - params.tpsl);
-                    params.total_traded_volume += nextAmount;
+                    direction[l] = 1.0;
+                    tpPrice[l] = entryPrice[l] * (1.0f + tpsl);
+                    slPrice[l] = entryPrice[l] * (1.0f - tpsl);
                 }
-                else if (shortCondition)
+                else
                 {
-                    state.in_position = true;
-                    state.position_type = "Short";
-                    state.entry_price = params.data[i].close;
-                    state.position_size = nextAmount / state.entry_price;
-                    state.tp_price = state.entry_price * (1.0f - params.tpsl);
-                    state.sl_price = state.entry_price * (1.0f + params.tpsl);
-                    params.total_traded_volume += nextAmount;
+                    direction[l] = -1.0;
+                    tpPrice[l] = entryPrice[l] * (1.0f - tpsl);
+                    slPrice[l] = entryPrice[l] * (1.0f + tpsl);
                 }
+                volume[l] += nextAmount[l];
+                if (skipAhead)
+                    exitBar[l] = SimulationKernel::findExitBar(*params.exits, params.data, i + 1,
+                                                               longCondition, tpPrice[l], slPrice[l]);
+            }
+            else if (direction[l] > 0.0)
+            {
+                if (highs[i] >= tpPrice[l])
+                {
+                    double profit = positionSize[l] * (tpPrice[l] - entryPrice[l]);
+                    balance[l] += profit;
+                    wins[l]++;
+                    nextAmount[l] = params.initial_trade_size;
+                }
+                else
+                {
+                    double loss = positionSize[l] * (entryPrice[l] - slPrice[l]);
+                    balance[l] -= loss;
+                    losses[l]++;
+                    nextAmount[l] *= params.multiplier;
+                }
+                closed = true;
             }
             else
             {
-                if (state.position_type == "Long")
+                if (lows[i] <= tpPrice[l])
                 {
-                    if (params.data[i].high >= state.tp_price)
-                    {
-                        double profit = state.position_size * (state.tp_price - state.entry_price);
-                        state.balance += profit;
-                        params.total_wins++;
-                        state.in_position = false;
-                        nextAmount = returned_balance;
-                        tradesMade++;
-                        localWaitCounter = waitCounterConst;
-                    }
-                    else if (params.data[i].low <= state.sl_price)
-                    {
-                        double loss = state.position_size * (state.entry_price - state.sl_price);
-                        state.balance -= loss;
-                        params.total_losses++;
-                        state.in_position = false;
-                        nextAmount *= params.multiplier;
-                        tradesMade++;
-                        localWaitCounter = waitCounterConst;
-                    }
+                    double profit = positionSize[l] * (entryPrice[l] - tpPrice[l]);
+                    balance[l] += profit;
+                    wins[l]++;
+                    nextAmount[l] = params.initial_trade_size;
                 }
-                else if (state.position_type == "Short")
+                else
                 {
-                    if (params.data[i].low <= state.tp_price)
-                    {
-                        double profit = state.position_size * (state.entry_price - state.tp_price);
-                        state.balance += profit;
-                        params.total_wins++;
-                        state.in_position = false;
-                        nextAmount = returned_balance;
-                        tradesMade++;
-                        localWaitCounter = waitCounterConst;
-                    }
-                    else if (params.data[i].high >= state.sl_price)
-                    {
-                        double loss = state.position_size * (state.sl_price - state.entry_price);
-                        state.balance -= loss;
-                        params.total_losses++;
-                        state.in_position = false;
-                        nextAmount *= params.multiplier;
-                        tradesMade++;
-                        localWaitCounter = waitCounterConst;
-                    }
+                    double loss = positionSize[l] * (slPrice[l] - entryPrice[l]);
+                    balance[l] -= loss;
+                    losses[l]++;
+                    nextAmount[l] *= params.multiplier;
                 }
+                closed = true;
             }
+
+            if (closed)
+            {
+                direction[l] = 0.0;
+                waitCounter[l] = waitCounterConst;
+                if (++tradesMade[l] >= params.max_trades)
+                {
+                    waitCounter[l] = INFINITY;
+                    activeLanes--;
+                }
+            }
+        }
+
+        // Continue at the next bar on which some lane can act: the exit of an open position or the
+        // first breakout after a flat lane's wait counter has run down. The bars in between only
+        // count down the wait counters.
+        if (skipAhead || skipFlat)
+        {
+            size_t next = dataSize;
+            for (size_t l = 0; l < usedLanes; ++l)
+            {
+                if (std::isinf(waitCounter[l]))
+                    continue; // unused or done
+                if (direction[l] != 0.0)
+                    next = std::min(next, skipAhead ? exitBar[l] : i + 1);
+                else if (skipFlat)
+                    next = std::min(next, SimulationKernel::findBreakoutBar(
+                                              *params.breakouts, params.data,
+                                              i + 1 + static_cast<size_t>(waitCounter[l])));
+                else
+                    next = i + 1;
+            }
+            const double skipped = static_cast<double>(next - (i + 1));
+            for (size_t l = 0; skipped > 0 && l < usedLanes; ++l)
+                waitCounter[l] = std::max(0.0, waitCounter[l] - skipped);
+            i = next - 1;
         }
     }
 
-    if (logFile.is_open())
-        logFile.close();
+    TradeSimulationBatchResult result;
+    for (size_t l = 0; l < L; ++l)
+    {
+        result.final_balance[l] = balance[l];
+        result.wins[l] = wins[l];
+        result.losses[l] = losses[l];
+        result.traded_volume[l] = volume[l];
+        result.updated_next_amount[l] = nextAmount[l];
+    }
+    return result;
+}
+
+TradeSimulationResult FibAlgoTrader::simulateTradesApplying(TradeSimulationParams &params)
+{
+    // Runs the kernel with observer, recording the closed trades too when there is a ledger.
+    auto runWith = [&params](auto &observer)
+    {
+        using namespace SimulationKernel;
+        if (params.ledger != nullptr)
+        {
+            RecordingObserver<std::remove_reference_t<decltype(observer)>> recorder(observer, *params.ledger, params);
+            return run<ResetToFirstBalance, TakeProfitFirst>(params, recorder);
+        }
+        return run<ResetToFirstBalance, TakeProfitFirst>(params, observer);
+    };
 
-    return TradeSimulationResult{state.balance, i, nextAmount};
+    if (params.event_log != nullptr)
+    {
+        const CandleView &data = params.data;
+        const size_t offset = data.offset();
+        params.event_log->window(offset + params.start_index, data.open_time()[params.start_index],
+                                 params.starting_state_balance, params.initial_trade_size,
+                                 params.sensitivity, params.tpsl);
+
+        SimulationKernel::EventObserver observer(*params.event_log, data);
+        TradeSimulationResult result = runWith(observer);
+
+        const size_t end = result.last_index;
+        params.event_log->end(offset + end,
+                              end < data.size() ? std::optional<int64_t>(data.open_time()[end]) : std::nullopt,
+                              result.final_balance);
+        return result;
+    }
+
+    // Without a shared log, this run keeps its own open until it returns.
+    std::unique_ptr<AsyncLogWriter> ownLog;
+    AsyncLogWriter *log = params.log_writer;
+    if (log == nullptr)
+    {
+        ownLog = std::make_unique<AsyncLogWriter>(params.logFileName);
+        log = ownLog.get();
+    }
+
+    // Pick the observer once instead of checking the log on every bar.
+    if (log->isOpen())
+    {
+        SimulationKernel::LogObserver observer(*log, params.data);
+        return runWith(observer);
+    }
+
+    SimulationKernel::NullObserver observer;
+    return runWith(observer);
 }
 
 OptimizationResult FibAlgoTrader::performRollingWindowOptimization(const OptimizationParams &params,
                                                                      std::string logging_output_directory,
                                                                      std::string symbol)
 {
-    std::vector<DataRow> allData = readCSV(params.csv_file);
+    CandleSeries allData = readCSV(params.csv_file);
     if (allData.empty())
     {
         std::cerr << "Error: No data found in the CSV file." << std::endl;
         return {1000.0f, 1000.0f, 1000.0f, 0, 0, 0};
     }
 
+    // One channel pass per sensitivity over the whole series, shared by every combination and window.
+    DonchianChannels channels(allData, params.sensitivity_values);
+    ExitFinder exits(allData);
+
     constexpr size_t MINUTES_PER_DAY = 24 * 60;
     int maxSensitivity = params.sensitivity_values.back();
     size_t lookbackSize = params.lookback_days * MINUTES_PER_DAY + maxSensitivity;
@@ -375,22 +449,41 @@ OptimizationResult FibAlgoTrader::performRollingWindowOptimization(const Optimiz
 
     size_t startIndex = lookbackSize;
 
-    // Create a unique log file name that includes the lookbackDays and applyTrades values
-    std::string logFileName = logging_output_directory + "/all_trading_logs_" + symbol + "_" +
-                              std::to_string(params.lookback_days) + "ld_" +
-                              std::to_string(params.apply_trades) + "at_" +
-                              HelperFunctions::getFormattedDate() + ".csv";
-
-    while (startIndex < allData.size())
+    // Create a unique log file name that includes the lookbackDays and applyTrades values. The date
+    // only has minutes, so a second run within the same minute gets a numbered name rather than
+    // appending to the first run's log.
+    const bool eventsOnly = (params.log_format == LogFormat::Events);
+    std::string logFileName = ResultsSink::uniquePath(
+        logging_output_directory + (eventsOnly ? "/all_trading_events_" : "/all_trading_logs_") +
+            symbol + "_" +
+            std::to_string(params.lookback_days) + "ld_" +
+            std::to_string(params.apply_trades) + "at_" +
+            HelperFunctions::getFormattedDate(),
+        params.log_format == LogFormat::Binary ? ".equity" : ".csv");
+    // Open for the whole run; every window's apply phase appends to it.
+    std::unique_ptr<AsyncLogWriter> log;
+    std::unique_ptr<TradeEventLog> events;
+    auto ledger = std::make_shared<TradeLedger>();
+    auto makeResult = [&]()
     {
-        // Optimization phase: get lookback data
-        std::vector<DataRow> lookbackData(allData.begin() + startIndex - lookbackSize,
-                                          allData.begin() + startIndex);
-        ResultHighBroke bestResult = optimizeParameters(lookbackData, params, 1000);
-
-        // Application phase: build the applyData vector.
-        std::vector<DataRow> applyData(allData.begin() + startIndex - bestResult.best_sensitivity,
-                                       allData.end());
+        OptimizationResult result(overallBalance, overallReducedBalance, nextAmount,
+                                  overallWins, overallLosses, overallTrades);
+        result.trades = ledger;
+        return result;
+    };
+    if (eventsOnly)
+        events = std::make_unique<TradeEventLog>(logFileName);
+    else
+        log = std::make_unique<AsyncLogWriter>(logFileName, params.log_format, params.csv_file);
+
+    // Applies bestResult from startIndex with at most maxTrades trades and no entries from
+    // entryEndIndex (a series index) on, adding the outcome to the running totals. Returns the number
+    // of bars it advanced.
+    auto applyWindow = [&](size_t startIndex, const ResultHighBroke &bestResult, size_t maxTrades,
+                           size_t entryEndIndex) -> size_t
+    {
+        // Application phase: from best_sensitivity candles before startIndex to the end of the series.
+        CandleView applyView(allData, startIndex - bestResult.best_sensitivity, allData.size());
 
         // Prepare local counters for simulation
         int applyWins = 0;
@@ -399,14 +492,14 @@ OptimizationResult FibAlgoTrader::performRollingWindowOptimization(const Optimiz
 
         // Construct the TradeSimulationParams.
         TradeSimulationParams applyParams(
-            applyData,
+            applyView,
             bestResult.best_sensitivity,
             bestResult.best_tpsl,
             applyWins,
             applyLosses,
             m_Multiplier,
-            bestResult.best_sensitivity, // start_index for applyData
-            params.apply_trades,
+            bestResult.best_sensitivity, // start_index within applyView
+            maxTrades,
             nextAmount,
             overallBalance,
             firstBalance,
@@ -416,6 +509,18 @@ OptimizationResult FibAlgoTrader::performRollingWindowOptimization(const Optimiz
 
         // Use the new log file name with the parameter info.
         applyParams.logFileName = logFileName;
+        applyParams.log_writer = log.get();
+        applyParams.event_log = events.get();
+        applyParams.ledger = ledger.get();
+        if (const DonchianChannel *channel = channels.find(bestResult.best_sensitivity))
+        {
+            applyParams.channel_high = channel->high.data() + applyView.offset();
+            applyParams.channel_low = channel->low.data() + applyView.offset();
+            applyParams.breakouts = channel;
+        }
+        applyParams.exits = &exits;
+        if (entryEndIndex != SIZE_MAX)
+            applyParams.entry_end_index = entryEndIndex - applyView.offset();
 
         TradeSimulationResult result = simulateTradesApplying(applyParams);
 
@@ -425,18 +530,141 @@ OptimizationResult FibAlgoTrader::performRollingWindowOptimization(const Optimiz
         overallTrades += (applyWins + applyLosses);
         nextAmount = result.updated_next_amount;
 
+        return result.last_index - bestResult.best_sensitivity;
+    };
+
+    if (params.stride_bars > 0)
+    {
+        // Fixed-stride walk-forward: every window is known up front, so all of them are optimized in
+        // parallel and then applied in order, each over its own stride.
+        std::vector<size_t> windowStarts;
+        for (size_t start = startIndex; start < allData.size(); start += params.stride_bars)
+            windowStarts.push_back(start);
+
+        std::vector<ResultHighBroke> windowBest(windowStarts.size());
+        TaskGroup windows(m_Pool);
+        for (size_t w = 0; w < windowStarts.size(); ++w)
+        {
+            windows.run([&, w]()
+                        {
+                CandleView lookbackView(allData, windowStarts[w] - lookbackSize, windowStarts[w]);
+                windowBest[w] = optimizeParameters(lookbackView, params, 1000, &channels, &exits); });
+        }
+        windows.wait();
+
+        // A position still open at the end of its stride runs on into the next one; the next
+        // parameters take over from the bar it is closed on.
+        size_t cursor = startIndex;
+        for (size_t w = 0; w < windowStarts.size(); ++w)
+        {
+            size_t windowEnd = std::min(windowStarts[w] + params.stride_bars, allData.size());
+            if (cursor >= windowEnd)
+                continue;
+            cursor += applyWindow(cursor, windowBest[w], SIZE_MAX, windowEnd);
+        }
+
+        return makeResult();
+    }
+
+    // Speculation: the next window starts where the apply phase stops, which only depends on the
+    // combination that wins the current window. While a window is optimized, the next windows of the
+    // combinations that won most often so far are optimized on the pool as well; a window whose start
+    // was predicted takes the speculative result, the others are discarded.
+    struct Speculation
+    {
+        size_t start_index;
+        ResultHighBroke result{};
+        std::unique_ptr<TaskGroup> task;
+    };
+    std::list<Speculation> speculations; // destroyed (waited for) before the data they read
+    const size_t tpslCount = params.tpsl_values.size();
+    const size_t comboCount = params.sensitivity_values.size() * tpslCount;
+    std::vector<size_t> timesChosen(comboCount, 0);
+    std::vector<size_t> comboRanking(comboCount);
+    std::iota(comboRanking.begin(), comboRanking.end(), 0);
+
+    auto speculate = [&](size_t windowStart)
+    {
+        // Most often chosen first; the sort is stable, so the latest winner leads its ties.
+        std::stable_sort(comboRanking.begin(), comboRanking.end(),
+                         [&](size_t a, size_t b) { return timesChosen[a] > timesChosen[b]; });
+
+        size_t launched = 0;
+        for (size_t k = 0; k < comboCount && launched < params.speculation_width; ++k)
+        {
+            const size_t combo = comboRanking[k];
+            const int sensitivity = params.sensitivity_values[combo / tpslCount];
+            const float tpsl = params.tpsl_values[combo % tpslCount];
+            const size_t next = nextWindowStart(allData, channels, exits, windowStart, sensitivity, tpsl,
+                                                params.apply_trades);
+            if (next <= windowStart || next >= allData.size())
+                continue;
+            bool known = std::any_of(speculations.begin(), speculations.end(),
+                                     [next](const Speculation &spec) { return spec.start_index == next; });
+            if (known)
+                continue;
+
+            Speculation &spec = speculations.emplace_back();
+            spec.start_index = next;
+            spec.task = std::make_unique<TaskGroup>(m_Pool);
+            spec.task->run([this, &allData, &channels, &exits, &params, &spec, lookbackSize]()
+                           {
+                CandleView lookbackView(allData, spec.start_index - lookbackSize, spec.start_index);
+                spec.result = optimizeParameters(lookbackView, params, 1000, &channels, &exits); });
+            ++launched;
+        }
+    };
+
+    while (startIndex < allData.size())
+    {
+        if (params.speculation_width > 0)
+            speculate(startIndex);
+
+        // Optimization phase: the lookback window is an index range into the loaded series.
+        ResultHighBroke bestResult{};
+        auto hit = std::find_if(speculations.begin(), speculations.end(),
+                                [startIndex](const Speculation &spec) { return spec.start_index == startIndex; });
+        if (hit != speculations.end())
+        {
+            hit->task->wait();
+            bestResult = hit->result;
+        }
+        else
+        {
+            CandleView lookbackView(allData, startIndex - lookbackSize, startIndex);
+            bestResult = optimizeParameters(lookbackView, params, 1000, &channels, &exits);
+        }
+
+        for (size_t k = 0; k < comboCount; ++k)
+        {
+            const size_t combo = comboRanking[k];
+            if (params.sensitivity_values[combo / tpslCount] == bestResult.best_sensitivity &&
+                params.tpsl_values[combo % tpslCount] == bestResult.best_tpsl)
+            {
+                timesChosen[combo]++;
+                std::rotate(comboRanking.begin(), comboRanking.begin() + k, comboRanking.begin() + k + 1);
+                break;
+            }
+        }
+
+        const size_t advanced = applyWindow(startIndex, bestResult, params.apply_trades, SIZE_MAX);
+
         // Update startIndex using the number of full-data candles processed
-        startIndex += (result.last_index - bestResult.best_sensitivity);
+        startIndex += advanced;
+
+        // Speculations for windows behind us can no longer be used; keep the running ones alive
+        // until they finish.
+        speculations.remove_if([startIndex](Speculation &spec)
+                               { return spec.start_index < startIndex && spec.task->finished(); });
 
-        if ((result.last_index - bestResult.best_sensitivity) == 0)
+        if (advanced == 0)
         {
             std::cerr << "Warning: No progress in simulation. Exiting loop." << std::endl;
             break;
         }
     }
 
-    return OptimizationResult(overallBalance, overallReducedBalance, nextAmount,
-                              overallWins, overallLosses, overallTrades);
+    return makeResult();
 }
 
 
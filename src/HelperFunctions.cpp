@@ -2,13 +2,13 @@
 #include <filesystem>
 #include <string>
 #include <vector>
-#include <fstream>
 #include <sstream>
-#include <stdexcept>
 #include <iomanip>
 #include <ctime>
+#include <cstdint>
 
 #include "HelperFunctions.hpp"
+#include "CandleLoader.hpp"
 
 namespace HelperFunctions {
     namespace fs = std::filesystem;
@@ -16,22 +16,120 @@ namespace HelperFunctions {
     std::string getFormattedDate() {
         auto now = std::chrono::system_clock::now();
         std::time_t nowTime = std::chrono::system_clock::to_time_t(now);
-        std::tm* localTime = std::localtime(&nowTime);
+        // localtime_r: symbols are optimized concurrently.
+        std::tm localTime{};
+        localtime_r(&nowTime, &localTime);
         std::ostringstream dateStream;
-        dateStream << std::put_time(localTime, "%m_%d_%Y_%H_%M");
+        dateStream << std::put_time(&localTime, "%m_%d_%Y_%H_%M");
         return dateStream.str();
     }
-    // Helper function to parse a date-time string in the format "YYYY-MM-DD HH:MM:SS".
-    std::time_t parseDateTime(const std::string &dateTimeStr)
+    namespace {
+        // Days since 1970-01-01 for a proleptic Gregorian date (Howard Hinnant's days_from_civil).
+        int64_t daysFromCivil(int64_t y, unsigned m, unsigned d)
+        {
+            y -= m <= 2;
+            const int64_t era = (y >= 0 ? y : y - 399) / 400;
+            const unsigned yoe = static_cast<unsigned>(y - era * 400);
+            const unsigned doy = (153 * (m + (m > 2 ? -3 : 9)) + 2) / 5 + d - 1;
+            const unsigned doe = yoe * 365 + yoe / 4 - yoe / 100 + doy;
+            return era * 146097 + static_cast<int64_t>(doe) - 719468;
+        }
+
+        void civilFromDays(int64_t z, int64_t &y, unsigned &m, unsigned &d)
+        {
+            z += 719468;
+            const int64_t era = (z >= 0 ? z : z - 146096) / 146097;
+            const unsigned doe = static_cast<unsigned>(z - era * 146097);
+            const unsigned yoe = (doe - doe / 1460 + doe / 36524 - doe / 146096) / 365;
+            const unsigned doy = doe - (365 * yoe + yoe / 4 - yoe / 100);
+            const unsigned mp = (5 * doy + 2) / 153;
+            d = doy - (153 * mp + 2) / 5 + 1;
+            m = mp < 10 ? mp + 3 : mp - 9;
+            y = static_cast<int64_t>(yoe) + era * 400 + (m <= 2);
+        }
+
+        inline bool readDigits(const char *p, int count, unsigned &value)
+        {
+            value = 0;
+            for (int k = 0; k < count; ++k)
+            {
+                unsigned digit = static_cast<unsigned>(p[k] - '0');
+                if (digit > 9)
+                    return false;
+                value = value * 10 + digit;
+            }
+            return true;
+        }
+
+        unsigned daysInMonth(unsigned year, unsigned month)
+        {
+            static const unsigned DAYS[12] = {31, 28, 31, 30, 31, 30, 31, 31, 30, 31, 30, 31};
+            const bool leap = (year % 4 == 0 && year % 100 != 0) || year % 400 == 0;
+            return (month == 2 && leap) ? 29 : DAYS[month - 1];
+        }
+
+        inline void writeDigits(char *p, int count, unsigned value)
+        {
+            for (int k = count - 1; k >= 0; --k)
+            {
+                p[k] = static_cast<char>('0' + value % 10);
+                value /= 10;
+            }
+        }
+    }
+
+    bool parseTimestamp(const char *text, size_t length, int64_t &epochSeconds)
+    {
+        // Fixed layout: YYYY-MM-DD HH:MM:SS
+        if (length != 19 || text[4] != '-' || text[7] != '-' || text[10] != ' ' ||
+            text[13] != ':' || text[16] != ':')
+            return false;
+
+        unsigned year, month, day, hour, minute, second;
+        if (!readDigits(text, 4, year) || !readDigits(text + 5, 2, month) ||
+            !readDigits(text + 8, 2, day) || !readDigits(text + 11, 2, hour) ||
+            !readDigits(text + 14, 2, minute) || !readDigits(text + 17, 2, second))
+            return false;
+        if (month < 1 || month > 12 || day < 1 || day > daysInMonth(year, month) ||
+            hour > 23 || minute > 59 || second > 59)
+            return false;
+
+        epochSeconds = daysFromCivil(year, month, day) * 86400 + hour * 3600 + minute * 60 + second;
+        return true;
+    }
+
+    void formatTimestamp(int64_t epochSeconds, char *out)
     {
-        std::tm tm = {};
-        std::istringstream ss(dateTimeStr);
-        ss >> std::get_time(&tm, "%Y-%m-%d %H:%M:%S");
-        if (ss.fail())
+        int64_t days = epochSeconds / 86400;
+        int64_t secondsOfDay = epochSeconds % 86400;
+        if (secondsOfDay < 0)
         {
-            throw std::runtime_error("Failed to parse date time: " + dateTimeStr);
+            secondsOfDay += 86400;
+            --days;
         }
-        return std::mktime(&tm);
+
+        int64_t year;
+        unsigned month, day;
+        civilFromDays(days, year, month, day);
+
+        writeDigits(out, 4, static_cast<unsigned>(year));
+        out[4] = '-';
+        writeDigits(out + 5, 2, month);
+        out[7] = '-';
+        writeDigits(out + 8, 2, day);
+        out[10] = ' ';
+        writeDigits(out + 11, 2, static_cast<unsigned>(secondsOfDay / 3600));
+        out[13] = ':';
+        writeDigits(out + 14, 2, static_cast<unsigned>(secondsOfDay / 60 % 60));
+        out[16] = ':';
+        writeDigits(out + 17, 2, static_cast<unsigned>(secondsOfDay % 60));
+    }
+
+    std::string formatTimestamp(int64_t epochSeconds)
+    {
+        std::string out(TIMESTAMP_LENGTH, '\0');
+        formatTimestamp(epochSeconds, &out[0]);
+        return out;
     }
 
     std::vector<std::string> get_symbols_from_directory(const std::string &directory_path)
@@ -39,69 +137,60 @@ namespace HelperFunctions {
         std::vector<std::string> symbols;
         for (const auto &entry : fs::directory_iterator(directory_path))
         {
-            if (entry.is_regular_file())
+            // Only CSV files are symbols; the binary candle caches live next to them.
+            if (entry.is_regular_file() && entry.path().extension() == ".csv")
             {
-                std::string file_name = entry.path().filename().string();
-                // Remove the ".csv" suffix (assumes all files end with ".csv")
-                if (file_name.size() > 4)
-                {
-                    std::string symbol = file_name.substr(0, file_name.size() - 4);
-                    symbols.push_back(symbol);
-                }
+                symbols.push_back(entry.path().stem().string());
             }
         }
         return symbols;
     }
 
+    namespace {
+        const char *issueName(TimestampIssueType type)
+        {
+            switch (type)
+            {
+            case TimestampIssueType::Gap:        return "gap";
+            case TimestampIssueType::Misaligned: return "misaligned";
+            case TimestampIssueType::Duplicate:  return "duplicate";
+            case TimestampIssueType::OutOfOrder: return "out of order";
+            case TimestampIssueType::Malformed:  return "malformed";
+            }
+            return "unknown";
+        }
+    }
+
     // Checks if the CSV file timestamps are in increasing order and exactly separated by the specified time frame (in minutes).
+    // Validation happens while the candles are loaded, which also builds the binary cache used by later loads.
     bool checkCSVIncreasingOrder(const std::string &file_path, int time_frame_minutes)
     {
-        int expected_interval = time_frame_minutes * 60; // convert minutes to seconds
+        constexpr size_t MAX_PRINTED_ISSUES = 10;
 
-        std::ifstream file(file_path);
-        if (!file.is_open())
+        ValidationReport report;
+        CandleLoader::load(file_path, time_frame_minutes * 60, report);
+        // A file without rows is fine here; the optimization reports it when it finds no data.
+        if (!report.opened)
         {
-            std::cerr << "Could not open file: " << file_path << std::endl;
+            std::cerr << "Could not load file: " << file_path << std::endl;
             return false;
         }
 
-        std::string line;
-        std::getline(file, line); // Skip header
-
-        std::time_t previous_timestamp = 0;
-        int line_number = 2; // First data line (line 1 is header)
-
-        while (std::getline(file, line))
+        for (size_t k = 0; k < report.issues.size() && k < MAX_PRINTED_ISSUES; ++k)
         {
-            std::istringstream ss(line);
-            std::string current_time;
-            std::getline(ss, current_time, ','); // Get the "Open time" column
-
-            try
-            {
-                std::time_t current_timestamp = parseDateTime(current_time);
-                if (previous_timestamp != 0)
-                {
-                    if (current_timestamp != previous_timestamp + expected_interval)
-                    {
-                        std::time_t expectedTimestamp = previous_timestamp + expected_interval;
-                        std::cerr << "Error: At line " << line_number 
-                                  << ", expected timestamp " 
-                                  << std::asctime(std::localtime(&expectedTimestamp))
-                                  << " but got " << current_time << std::endl;
-                        return false;
-                    }
-                }
-                previous_timestamp = current_timestamp;
-            }
-            catch (const std::exception &e)
-            {
-                std::cerr << "Error processing line " << line_number << ": " << e.what() << std::endl;
-                return false;
-            }
-            ++line_number;
+            const TimestampIssue &issue = report.issues[k];
+            std::cerr << "Error: At line " << issue.line << " (" << issueName(issue.type) << ")";
+            if (issue.type == TimestampIssueType::Malformed)
+                std::cerr << std::endl;
+            else
+                std::cerr << ", expected timestamp " << formatTimestamp(issue.expected)
+                          << " but got " << formatTimestamp(issue.actual) << std::endl;
         }
-        return true;
+        if (report.issues.size() > MAX_PRINTED_ISSUES)
+        {
+            std::cerr << "... " << report.issues.size() - MAX_PRINTED_ISSUES << " more issues in " << file_path << std::endl;
+        }
+        return report.ok();
     }
 
     // Checks all CSV files in a folder using the provided time frame in minutes.
@@ -0,0 +1,71 @@
+#include "MappedFile.hpp"
+
+#include <utility>
+#include <fcntl.h>
+#include <sys/mman.h>
+#include <sys/stat.h>
+#include <unistd.h>
+
+MappedFile::MappedFile(MappedFile &&other) noexcept
+    : m_Data(std::exchange(other.m_Data, nullptr)),
+      m_Size(std::exchange(other.m_Size, 0)),
+      m_Open(std::exchange(other.m_Open, false))
+{
+}
+
+MappedFile &MappedFile::operator=(MappedFile &&other) noexcept
+{
+    if (this != &other)
+    {
+        close();
+        m_Data = std::exchange(other.m_Data, nullptr);
+        m_Size = std::exchange(other.m_Size, 0);
+        m_Open = std::exchange(other.m_Open, false);
+    }
+    return *this;
+}
+
+bool MappedFile::open(const std::string &path)
+{
+    close();
+
+    int fd = ::open(path.c_str(), O_RDONLY);
+    if (fd < 0)
+        return false;
+
+    struct stat st;
+    if (::fstat(fd, &st) != 0)
+    {
+        ::close(fd);
+        return false;
+    }
+
+    m_Size = static_cast<size_t>(st.st_size);
+    if (m_Size > 0)
+    {
+        void *ptr = ::mmap(nullptr, m_Size, PROT_READ, MAP_PRIVATE, fd, 0);
+        if (ptr == MAP_FAILED)
+        {
+            ::close(fd);
+            m_Size = 0;
+            return false;
+        }
+        // Candle files are scanned front to back.
+        ::madvise(ptr, m_Size, MADV_SEQUENTIAL);
+        m_Data = static_cast<const char *>(ptr);
+    }
+
+    // The mapping stays valid after the descriptor is closed.
+    ::close(fd);
+    m_Open = true;
+    return true;
+}
+
+void MappedFile::close()
+{
+    if (m_Data != nullptr)
+        ::munmap(const_cast<char *>(m_Data), m_Size);
+    m_Data = nullptr;
+    m_Size = 0;
+    m_Open = false;
+}
@@ -0,0 +1,168 @@
+#include "ResultsSink.hpp"
+
+#include <cerrno>
+#include <charconv>
+#include <iostream>
+#include <utility>
+#include <fcntl.h>
+#include <unistd.h>
+
+namespace {
+    // Same text as writing the value to an ostream with default formatting.
+    void appendCsvValue(std::string &out, const nlohmann::ordered_json &value)
+    {
+        char text[32];
+        if (value.is_number_float())
+        {
+            out.append(text, std::to_chars(text, text + sizeof(text), value.get<double>(),
+                                           std::chars_format::general, 6).ptr);
+        }
+        else if (value.is_number_unsigned())
+        {
+            out.append(text, std::to_chars(text, text + sizeof(text), value.get<uint64_t>()).ptr);
+        }
+        else if (value.is_number_integer())
+        {
+            out.append(text, std::to_chars(text, text + sizeof(text), value.get<int64_t>()).ptr);
+        }
+        else if (value.is_string())
+        {
+            const std::string &s = value.get_ref<const std::string &>();
+            if (s.find_first_of(",\"\n") == std::string::npos)
+            {
+                out += s;
+                return;
+            }
+            out += '"';
+            for (char c : s)
+            {
+                if (c == '"')
+                    out += '"';
+                out += c;
+            }
+            out += '"';
+        }
+        else if (value.is_boolean())
+        {
+            out += value.get<bool>() ? "true" : "false";
+        }
+    }
+}
+
+ResultsSink::ResultsSink(const std::string &path, std::vector<std::string> columns, ResultsFormat format,
+                         std::chrono::milliseconds flushInterval)
+    : m_Path(path),
+      m_Columns(std::move(columns)),
+      m_Format(format),
+      m_FlushInterval(flushInterval),
+      m_LastFlush(std::chrono::steady_clock::now())
+{
+    m_File.open(path, std::ios::out | std::ios::trunc);
+    if (!m_File.is_open())
+    {
+        std::cerr << "Error: Could not open results file " << path << std::endl;
+        return;
+    }
+
+    if (m_Format == ResultsFormat::Csv)
+    {
+        std::string header;
+        for (size_t c = 0; c < m_Columns.size(); ++c)
+            header += (c > 0 ? "," : "") + m_Columns[c];
+        m_File << header << '\n';
+    }
+    else
+    {
+        // The JSON file is rewritten as a whole on every flush.
+        m_File << m_Written.dump() << '\n';
+        m_File.close();
+    }
+}
+
+ResultsSink::~ResultsSink()
+{
+    flush();
+}
+
+void ResultsSink::submit(size_t slot, nlohmann::ordered_json row)
+{
+    std::lock_guard<std::mutex> lock(m_Mutex);
+    m_Waiting.emplace(slot, std::move(row));
+
+    if (m_FlushInterval > std::chrono::milliseconds::zero() &&
+        std::chrono::steady_clock::now() - m_LastFlush >= m_FlushInterval)
+        flushLocked();
+}
+
+void ResultsSink::flush()
+{
+    std::lock_guard<std::mutex> lock(m_Mutex);
+    flushLocked();
+}
+
+void ResultsSink::flushLocked()
+{
+    m_LastFlush = std::chrono::steady_clock::now();
+
+    std::string csv;
+    bool wrote = false;
+    for (auto next = m_Waiting.begin(); next != m_Waiting.end() && next->first == m_NextSlot;
+         next = m_Waiting.erase(next))
+    {
+        if (m_Format == ResultsFormat::Csv)
+        {
+            for (size_t c = 0; c < m_Columns.size(); ++c)
+            {
+                if (c > 0)
+                    csv += ',';
+                auto value = next->second.find(m_Columns[c]);
+                if (value != next->second.end())
+                    appendCsvValue(csv, *value);
+            }
+            csv += '\n';
+        }
+        else
+        {
+            m_Written.push_back(std::move(next->second));
+        }
+        ++m_NextSlot;
+        wrote = true;
+    }
+    if (!wrote)
+        return;
+
+    if (m_Format == ResultsFormat::Csv)
+    {
+        if (m_File.is_open())
+        {
+            m_File << csv;
+            m_File.flush();
+        }
+        return;
+    }
+
+    std::ofstream file(m_Path, std::ios::out | std::ios::trunc);
+    if (!file.is_open())
+    {
+        std::cerr << "Error: Could not write results file " << m_Path << std::endl;
+        return;
+    }
+    file << m_Written.dump(2) << '\n';
+}
+
+std::string ResultsSink::uniquePath(const std::string &stem, const std::string &extension)
+{
+    for (size_t attempt = 1;; ++attempt)
+    {
+        std::string path = stem + (attempt > 1 ? "_" + std::to_string(attempt) : "") + extension;
+        // O_EXCL: exactly one caller, in any process, creates a given name.
+        int fd = ::open(path.c_str(), O_WRONLY | O_CREAT | O_EXCL, 0644);
+        if (fd >= 0)
+        {
+            ::close(fd);
+            return path;
+        }
+        if (errno != EEXIST)
+            return path; // let the caller report the error when opening it
+    }
+}
@@ -0,0 +1,192 @@
+#include "ThreadPool.hpp"
+
+#include <algorithm>
+#include <utility>
+
+namespace {
+    // Pool and queue index of the worker running on this thread, if any.
+    thread_local const ThreadPool *t_Pool = nullptr;
+    thread_local size_t t_Index = 0;
+}
+
+ThreadPool::ThreadPool(size_t workers)
+{
+    if (workers == 0)
+        workers = std::max(1u, std::thread::hardware_concurrency());
+
+    m_Queues.reserve(workers);
+    for (size_t w = 0; w < workers; ++w)
+        m_Queues.push_back(std::make_unique<WorkQueue>());
+
+    m_Workers.reserve(workers);
+    for (size_t w = 0; w < workers; ++w)
+        m_Workers.emplace_back(&ThreadPool::workerLoop, this, w);
+}
+
+ThreadPool::~ThreadPool()
+{
+    {
+        std::lock_guard<std::mutex> lock(m_SleepMutex);
+        m_Stopping = true;
+    }
+    m_Ready.notify_all();
+    for (std::thread &worker : m_Workers)
+        worker.join();
+}
+
+void ThreadPool::enqueue(std::function<void()> task)
+{
+    // Counted before it is visible, so m_Queued never drops below the real number of queued tasks.
+    m_Queued.fetch_add(1, std::memory_order_release);
+    WorkQueue &queue = (t_Pool == this) ? *m_Queues[t_Index] : m_Injected;
+    {
+        std::lock_guard<std::mutex> lock(queue.mutex);
+        queue.tasks.push_back(std::move(task));
+    }
+
+    // Taking the sleep mutex orders the notify after a sleeping worker's check of m_Queued.
+    {
+        std::lock_guard<std::mutex> lock(m_SleepMutex);
+    }
+    m_Ready.notify_one();
+}
+
+bool ThreadPool::take(size_t self, std::function<void()> &task)
+{
+    if (m_Queued.load(std::memory_order_acquire) == 0)
+        return false;
+
+    auto popBack = [&](WorkQueue &queue)
+    {
+        std::lock_guard<std::mutex> lock(queue.mutex);
+        if (queue.tasks.empty())
+            return false;
+        task = std::move(queue.tasks.back());
+        queue.tasks.pop_back();
+        return true;
+    };
+    auto popFront = [&](WorkQueue &queue)
+    {
+        std::lock_guard<std::mutex> lock(queue.mutex);
+        if (queue.tasks.empty())
+            return false;
+        task = std::move(queue.tasks.front());
+        queue.tasks.pop_front();
+        return true;
+    };
+
+    // Own work first, then work from outside the pool, then steal, starting after our own queue so
+    // thieves spread over the victims.
+    const size_t count = m_Queues.size();
+    bool found = (self < count && popBack(*m_Queues[self])) || popFront(m_Injected);
+    for (size_t k = 1; !found && k <= count; ++k)
+    {
+        size_t victim = (self < count ? self + k : k - 1) % count;
+        found = (victim != self) && popFront(*m_Queues[victim]);
+    }
+
+    if (found)
+        m_Queued.fetch_sub(1, std::memory_order_relaxed);
+    return found;
+}
+
+void ThreadPool::workerLoop(size_t index)
+{
+    t_Pool = this;
+    t_Index = index;
+
+    for (;;)
+    {
+        std::function<void()> task;
+        if (take(index, task))
+        {
+            task();
+            continue;
+        }
+
+        std::unique_lock<std::mutex> lock(m_SleepMutex);
+        m_Ready.wait(lock, [this]() { return m_Stopping || m_Queued.load(std::memory_order_acquire) > 0; });
+        if (m_Stopping && m_Queued.load(std::memory_order_acquire) == 0)
+            return;
+    }
+}
+
+TaskGroup::~TaskGroup()
+{
+    // Without a wait() (skipped or thrown out of), tasks not started yet are not run at all.
+    {
+        std::lock_guard<std::mutex> lock(m_State->mutex);
+        m_State->pending -= m_State->queued.size();
+        m_State->queued.clear();
+    }
+    complete();
+}
+
+void TaskGroup::wait()
+{
+    complete();
+
+    std::exception_ptr error;
+    {
+        std::lock_guard<std::mutex> lock(m_State->mutex);
+        error = std::exchange(m_State->error, nullptr);
+    }
+    if (error)
+        std::rethrow_exception(error);
+}
+
+void TaskGroup::complete()
+{
+    for (;;)
+    {
+        // Newest first, like a worker's own deque; workers start the oldest.
+        if (m_State->runNext(true))
+            continue;
+
+        // The remaining tasks are running on other threads, unless one of them queued another.
+        std::unique_lock<std::mutex> lock(m_State->mutex);
+        m_State->changed.wait(lock, [this]() { return m_State->pending == 0 || !m_State->queued.empty(); });
+        if (m_State->pending == 0)
+            return;
+    }
+}
+
+bool TaskGroup::State::runNext(bool newest)
+{
+    std::function<void()> task;
+    {
+        std::lock_guard<std::mutex> lock(mutex);
+        if (queued.empty())
+            return false;
+        if (newest)
+        {
+            task = std::move(queued.back());
+            queued.pop_back();
+        }
+        else
+        {
+            task = std::move(queued.front());
+            queued.pop_front();
+        }
+    }
+
+    std::exception_ptr thrown;
+    try
+    {
+        task();
+    }
+    catch (...)
+    {
+        thrown = std::current_exception();
+    }
+    task = nullptr; // release its captures before the group can see it finish
+
+    {
+        std::lock_guard<std::mutex> lock(mutex);
+        if (thrown && !error)
+            error = thrown;
+        --pending;
+    }
+    changed.notify_all();
+    return true;
+}
@@ -0,0 +1,212 @@
+#include "TradeEventLog.hpp"
+#include "HelperFunctions.hpp"
+#include "MappedFile.hpp"
+
+#include <charconv>
+#include <iostream>
+#include <string_view>
+
+namespace {
+    constexpr size_t FLUSH_SIZE = size_t(1) << 16; // buffered bytes before a write
+
+    template <class T>
+    void appendNumber(std::string &out, T value)
+    {
+        // Shortest text that reads back to the same value.
+        char text[32];
+        out.append(text, std::to_chars(text, text + sizeof(text), value).ptr);
+    }
+
+    const char *sideName(PositionSide side)
+    {
+        switch (side)
+        {
+        case PositionSide::Long:
+            return "Long";
+        case PositionSide::Short:
+            return "Short";
+        default:
+            return "";
+        }
+    }
+
+    template <class T>
+    bool parseNumber(std::string_view text, T &value)
+    {
+        auto [end, ec] = std::from_chars(text.data(), text.data() + text.size(), value);
+        return ec == std::errc() && end == text.data() + text.size();
+    }
+}
+
+TradeEventLog::TradeEventLog(const std::string &path)
+    : m_File(path, std::ios::out | std::ios::trunc | std::ios::binary)
+{
+    if (!m_File.is_open())
+    {
+        std::cerr << "Error: Could not open event log " << path << std::endl;
+        return;
+    }
+    m_File << "Event,Bar,Open time,Side,Price,Amount,PnL,Balance,Sensitivity,TPSL\n";
+}
+
+TradeEventLog::~TradeEventLog()
+{
+    if (m_File.is_open())
+        m_File << m_Buffer;
+}
+
+void TradeEventLog::window(size_t bar, int64_t openTime, double balance, double amount, int sensitivity, float tpsl)
+{
+    m_Sensitivity = sensitivity;
+    m_Tpsl = tpsl;
+    row("Window", bar, openTime, PositionSide::Flat, std::nullopt, amount, std::nullopt, balance);
+}
+
+void TradeEventLog::entry(size_t bar, int64_t openTime, PositionSide side, double price, double amount)
+{
+    row("Entry", bar, openTime, side, price, amount, std::nullopt, std::nullopt);
+}
+
+void TradeEventLog::exit(size_t bar, int64_t openTime, PositionSide side, double price, double pnl, double balance)
+{
+    row("Exit", bar, openTime, side, price, std::nullopt, pnl, balance);
+}
+
+void TradeEventLog::end(size_t bar, std::optional<int64_t> openTime, double balance)
+{
+    row("End", bar, openTime, PositionSide::Flat, std::nullopt, std::nullopt, std::nullopt, balance);
+}
+
+void TradeEventLog::row(const char *event, size_t bar, std::optional<int64_t> openTime, PositionSide side,
+                        std::optional<double> price, std::optional<double> amount, std::optional<double> pnl,
+                        std::optional<double> balance)
+{
+    if (!m_File.is_open())
+        return;
+
+    std::string &out = m_Buffer;
+    out += event;
+    out += ',';
+    appendNumber(out, bar);
+    out += ',';
+    if (openTime)
+        out += HelperFunctions::formatTimestamp(*openTime);
+    out += ',';
+    out += sideName(side);
+    out += ',';
+    if (price)
+        appendNumber(out, static_cast<float>(*price)); // candle precision
+    out += ',';
+    if (amount)
+        appendNumber(out, *amount);
+    out += ',';
+    if (pnl)
+        appendNumber(out, *pnl);
+    out += ',';
+    if (balance)
+        appendNumber(out, *balance);
+    out += ',';
+    appendNumber(out, m_Sensitivity);
+    out += ',';
+    appendNumber(out, m_Tpsl);
+    out += '\n';
+
+    if (out.size() >= FLUSH_SIZE)
+    {
+        m_File << out;
+        out.clear();
+    }
+}
+
+bool TradeEventLog::reconstructCurve(const std::string &path, const CandleSeries &candles,
+                                     std::vector<EquityLog::EquityRecord> &curve)
+{
+    MappedFile file(path);
+    if (!file.is_open())
+    {
+        std::cerr << "Error: Could not open event log " << path << std::endl;
+        return false;
+    }
+
+    const int64_t *time = candles.open_time();
+    bool inWindow = false;
+    size_t nextBar = 0; // first bar of the window without a curve record yet
+    double balance = 0.0;
+
+    // Adds the bars [nextBar, endBar) at the current balance.
+    auto fillTo = [&](size_t endBar)
+    {
+        if (endBar > candles.size() || endBar < nextBar)
+            return false;
+        for (; nextBar < endBar; ++nextBar)
+            curve.push_back({time[nextBar], balance});
+        return true;
+    };
+
+    std::string_view text(file.data(), file.size());
+    size_t lineNumber = 0;
+    while (!text.empty())
+    {
+        const size_t lineEnd = text.find('\n');
+        std::string_view line = text.substr(0, lineEnd);
+        text.remove_prefix(lineEnd == std::string_view::npos ? text.size() : lineEnd + 1);
+        if (lineNumber++ == 0 || line.empty())
+            continue; // header
+
+        std::string_view fields[10];
+        size_t count = 0;
+        for (size_t from = 0; count < 10; ++count)
+        {
+            const size_t comma = line.find(',', from);
+            fields[count] = line.substr(from, comma == std::string_view::npos ? std::string_view::npos : comma - from);
+            if (comma == std::string_view::npos)
+            {
+                ++count;
+                break;
+            }
+            from = comma + 1;
+        }
+
+        size_t bar = 0;
+        const std::string_view event = fields[0];
+        bool ok = (count == 10) && parseNumber(fields[1], bar);
+        // Rows tied to a candle must name the same time as the candles at that bar.
+        if (ok && bar < candles.size() && !fields[2].empty())
+            ok = (fields[2] == HelperFunctions::formatTimestamp(time[bar]));
+
+        if (ok && event == "Window")
+        {
+            ok = !inWindow && bar < candles.size() && parseNumber(fields[7], balance);
+            inWindow = true;
+            nextBar = bar;
+        }
+        else if (ok && event == "Exit")
+        {
+            // The exit bar itself still starts at the old balance.
+            ok = inWindow && fillTo(bar + 1) && parseNumber(fields[7], balance);
+        }
+        else if (ok && event == "End")
+        {
+            ok = inWindow && fillTo(bar);
+            inWindow = false;
+        }
+        else if (ok && event != "Entry")
+        {
+            ok = false;
+        }
+
+        if (!ok)
+        {
+            std::cerr << "Error: Event log " << path << " line " << lineNumber
+                      << " is malformed or does not match the candles." << std::endl;
+            return false;
+        }
+    }
+
+    if (inWindow)
+    {
+        std::cerr << "Error: Event log " << path << " ends inside a window." << std::endl;
+        return false;
+    }
+    return true;
+}
@@ -0,0 +1,107 @@
+#include "TradeLedger.hpp"
+#include "HelperFunctions.hpp"
+
+#include <charconv>
+#include <cstring>
+#include <fstream>
+#include <type_traits>
+
+namespace {
+    constexpr size_t COLUMN_ALIGNMENT = 64;
+
+    template <class T>
+    void appendNumber(std::string &out, T value)
+    {
+        char text[32];
+        out.append(text, std::to_chars(text, text + sizeof(text), value).ptr);
+    }
+}
+
+TradeLedger::TradeLedger(size_t capacity)
+{
+    if (capacity > 0)
+        allocate(capacity);
+}
+
+void TradeLedger::allocate(size_t capacity)
+{
+    // Column sizes rounded up to the alignment, plus room to align the arena itself.
+    auto columnBytes = [capacity](size_t elementSize)
+    {
+        return (capacity * elementSize + COLUMN_ALIGNMENT - 1) / COLUMN_ALIGNMENT * COLUMN_ALIGNMENT;
+    };
+    const size_t total = 4 * columnBytes(sizeof(int64_t)) + 2 * columnBytes(sizeof(double)) +
+                         4 * columnBytes(sizeof(float)) + columnBytes(sizeof(int)) +
+                         columnBytes(sizeof(PositionSide)) + COLUMN_ALIGNMENT;
+
+    std::unique_ptr<std::byte[]> arena = std::make_unique<std::byte[]>(total);
+    std::byte *cursor = arena.get();
+    cursor += (COLUMN_ALIGNMENT - reinterpret_cast<uintptr_t>(cursor) % COLUMN_ALIGNMENT) % COLUMN_ALIGNMENT;
+
+    // Carves the next column out of the arena and moves the recorded values into it.
+    auto place = [&](auto *&column)
+    {
+        using T = std::remove_reference_t<decltype(*column)>;
+        T *moved = reinterpret_cast<T *>(cursor);
+        if (m_Size > 0)
+            std::memcpy(moved, column, m_Size * sizeof(T));
+        column = moved;
+        cursor += columnBytes(sizeof(T));
+    };
+    place(m_EntryBar);
+    place(m_ExitBar);
+    place(m_EntryTime);
+    place(m_ExitTime);
+    place(m_Pnl);
+    place(m_Balance);
+    place(m_EntryPrice);
+    place(m_ExitPrice);
+    place(m_Amount);
+    place(m_Tpsl);
+    place(m_Sensitivity);
+    place(m_Side);
+
+    m_Arena = std::move(arena);
+    m_Capacity = capacity;
+}
+
+bool TradeLedger::writeCsv(const std::string &path) const
+{
+    std::string out = "Entry bar,Exit bar,Entry time,Exit time,Side,Entry price,Exit price,Amount,PnL,Balance,Sensitivity,TPSL\n";
+    out.reserve(out.size() + m_Size * 160);
+
+    char time[HelperFunctions::TIMESTAMP_LENGTH];
+    for (size_t n = 0; n < m_Size; ++n)
+    {
+        appendNumber(out, m_EntryBar[n]);
+        out += ',';
+        appendNumber(out, m_ExitBar[n]);
+        out += ',';
+        HelperFunctions::formatTimestamp(m_EntryTime[n], time);
+        out.append(time, sizeof(time));
+        out += ',';
+        HelperFunctions::formatTimestamp(m_ExitTime[n], time);
+        out.append(time, sizeof(time));
+        out += (m_Side[n] == PositionSide::Long) ? ",Long," : ",Short,";
+        appendNumber(out, m_EntryPrice[n]);
+        out += ',';
+        appendNumber(out, m_ExitPrice[n]);
+        out += ',';
+        appendNumber(out, m_Amount[n]);
+        out += ',';
+        appendNumber(out, m_Pnl[n]);
+        out += ',';
+        appendNumber(out, m_Balance[n]);
+        out += ',';
+        appendNumber(out, m_Sensitivity[n]);
+        out += ',';
+        appendNumber(out, m_Tpsl[n]);
+        out += '\n';
+    }
+
+    std::ofstream file(path, std::ios::out | std::ios::binary | std::ios::trunc);
+    if (!file.is_open())
+        return false;
+    file.write(out.data(), static_cast<std::streamsize>(out.size()));
+    return file.good();
+}
@@ -5,6 +5,7 @@
 #include <iomanip>
 #include <iostream>
 #include <mutex>
+#include <sstream>
 #include <string>
 #include <thread>
 #include <vector>
@@ -20,8 +21,8 @@
 
 #include "FibAlgoTrader.hpp"
 #include "HelperFunctions.hpp"
-#include <cstdlib> // For std::rand and std::srand
-#include <ctime>   // For std::time
+#include "ResultsSink.hpp"
+#include "TradeLedger.hpp"
 
 void runOptimizationForSymbol(const std::string &symbol,
                               const std::string &inputDir,
@@ -32,19 +33,70 @@ void runOptimizationForSymbol(const std::string &symbol,
                               const std::vector<float> &tpslValues,
                               FibAlgoTrader &trader) {
     std::string dateStr = HelperFunctions::getFormattedDate();
-    // Generate random number and use it inside the file name so that it's unique
-    std::srand(static_cast<unsigned>(std::time(nullptr))); // Seed the random number generator
-    int randomNum = std::rand();
-    std::string performanceOutput = outputDir + "/performance_" + symbol + "_" + dateStr + "_" + std::to_string(randomNum) + ".csv";
-
-    // Write header once
-    {
-        std::ofstream perfFile(performanceOutput, std::ios::out);
-        perfFile << "Symbol,LookbackDays,ApplyTrades,OverallBalance,OverallReducedBalance,NextAmount,Wins,Losses,TotalTrades,WinRatio" << std::endl;
-    }
+    // Numbered if a run in the same minute already wrote this symbol's results.
+    const ResultsFormat performanceFormat = ResultsFormat::Csv;
+    std::string performanceOutput = ResultsSink::uniquePath(outputDir + "/performance_" + symbol + "_" + dateStr,
+                                                            performanceFormat == ResultsFormat::Json ? ".json" : ".csv");
+
+    // Configurations finish in any order; the sink keeps their rows and writes them in configuration
+    // order once the symbol is done.
+    ResultsSink perfSink(performanceOutput,
+                         {"Symbol", "LookbackDays", "ApplyTrades", "OverallBalance", "OverallReducedBalance",
+                          "NextAmount", "Wins", "Losses", "TotalTrades", "WinRatio"},
+                         performanceFormat);
 
     std::string csvFilePath = inputDir + "/" + symbol + ".csv";
 
+    // One run per (lookback days, apply trades) configuration, in the order of the arrays.
+    struct ConfigRun {
+        int lookbackDays;
+        int applyTrades;
+        OptimizationResult result;
+    };
+    std::vector<ConfigRun> runs;
+    for (int lookbackDays : lookbackDaysArray) {
+        for (int applyTrades : applyTradesArray) {
+            runs.push_back({lookbackDays, applyTrades, OptimizationResult(0, 0, 0, 0, 0, 0)});
+        }
+    }
+
+    // The configurations are independent, so they all run concurrently on the trader's pool.
+    TaskGroup configTasks(trader.pool());
+    for (size_t c = 0; c < runs.size(); ++c) {
+        configTasks.run([&, c]() {
+            ConfigRun &run = runs[c];
+
+            // Built first and written in one piece: other runs print concurrently.
+            std::ostringstream message;
+            message << "Optimizing for " << symbol 
+                    << " with lookback days: " << run.lookbackDays 
+                    << " and apply trades: " << run.applyTrades 
+                    << " (CSV: " << csvFilePath << ")" << std::endl;
+            std::cout << message.str() << std::flush;
+
+            OptimizationParams optParams(csvFilePath, sensitivityValues, tpslValues, run.lookbackDays, run.applyTrades, 0.00f);
+            // Also optimize the four most likely next windows ahead; these share the pool's workers
+            // with the other configurations.
+            optParams.speculation_width = 4;
+            run.result = trader.performRollingWindowOptimization(optParams, outputDir, symbol);
+            const OptimizationResult &result = run.result;
+            float winRatio = (result.total_trades > 0) ? static_cast<float>(result.wins) / result.total_trades : 0.0f;
+
+            perfSink.submit(c, {{"Symbol", symbol},
+                                {"LookbackDays", run.lookbackDays},
+                                {"ApplyTrades", run.applyTrades},
+                                {"OverallBalance", result.overall_balance},
+                                {"OverallReducedBalance", result.overall_reduced_balance},
+                                {"NextAmount", result.final_next_amount},
+                                {"Wins", result.wins},
+                                {"Losses", result.losses},
+                                {"TotalTrades", result.total_trades},
+                                {"WinRatio", winRatio}});
+        });
+    }
+    configTasks.wait();
+    perfSink.flush();
+
     // Variables to track the best performance
     float bestOverallBalance = -1;
     float bestOverallReducedBalance = 0;
@@ -55,53 +107,48 @@ void runOptimizationForSymbol(const std::string &symbol,
     int bestWins = 0;
     int bestLosses = 0;
     int bestTotalTrades = 0;
-
-    // Loop through different parameter combinations
-    for (int lookbackDays : lookbackDaysArray) {
-        for (int applyTrades : applyTradesArray) {
-            std::cout << "Optimizing for " << symbol 
-                      << " with lookback days: " << lookbackDays 
-                      << " and apply trades: " << applyTrades 
-                      << " (CSV: " << csvFilePath << ")" << std::endl;
-
-            OptimizationParams optParams(csvFilePath, sensitivityValues, tpslValues, lookbackDays, applyTrades, 0.00f);
-            OptimizationResult result = trader.performRollingWindowOptimization(optParams, outputDir, symbol);
-            float winRatio = (result.total_trades > 0) ? static_cast<float>(result.wins) / result.total_trades : 0.0f;
-
-            // Append the results to the performance CSV
-            {
-                std::ofstream perfFile(performanceOutput, std::ios::app);
-                perfFile << symbol << "," << lookbackDays << "," << applyTrades << ","
-                         << result.overall_balance << "," << result.overall_reduced_balance << ","
-                         << result.final_next_amount << "," << result.wins << "," << result.losses << ","
-                         << result.total_trades << "," << winRatio << std::endl;
-            }
-
-            // Update best performance if this combination is better
-            if (result.overall_balance > bestOverallBalance) {
-                bestOverallBalance = result.overall_balance;
-                bestOverallReducedBalance = result.overall_reduced_balance;
-                bestLookbackDays = lookbackDays;
-                bestApplyTrades = applyTrades;
-                bestNextAmount = result.final_next_amount;
-                bestWins = result.wins;
-                bestLosses = result.losses;
-                bestTotalTrades = result.total_trades;
-                bestWinRatio = winRatio;
-            }
+    const ConfigRun *bestRun = nullptr;
+
+    // Pick the best configuration in configuration order, so ties resolve as in a serial run
+    for (const ConfigRun &run : runs) {
+        const OptimizationResult &result = run.result;
+        float winRatio = (result.total_trades > 0) ? static_cast<float>(result.wins) / result.total_trades : 0.0f;
+
+        // Update best performance if this combination is better
+        if (result.overall_balance > bestOverallBalance) {
+            bestOverallBalance = result.overall_balance;
+            bestOverallReducedBalance = result.overall_reduced_balance;
+            bestLookbackDays = run.lookbackDays;
+            bestApplyTrades = run.applyTrades;
+            bestNextAmount = result.final_next_amount;
+            bestWins = result.wins;
+            bestLosses = result.losses;
+            bestTotalTrades = result.total_trades;
+            bestWinRatio = winRatio;
+            bestRun = &run;
         }
     }
 
     // Print summary for the symbol
-    std::cout << "Best performance for " << symbol 
-              << " with lookback days: " << bestLookbackDays 
-              << " and apply trades: " << bestApplyTrades 
-              << " Overall balance: " << bestOverallBalance 
-              << " Overall reduced balance: " << bestOverallReducedBalance 
-              << " Next amount: " << bestNextAmount 
-              << " Wins: " << bestWins << " Losses: " << bestLosses 
-              << " Total trades: " << bestTotalTrades 
-              << " Win ratio: " << bestWinRatio << std::endl;
+    std::ostringstream summary;
+    summary << "Best performance for " << symbol 
+            << " with lookback days: " << bestLookbackDays 
+            << " and apply trades: " << bestApplyTrades 
+            << " Overall balance: " << bestOverallBalance 
+            << " Overall reduced balance: " << bestOverallReducedBalance 
+            << " Next amount: " << bestNextAmount 
+            << " Wins: " << bestWins << " Losses: " << bestLosses 
+            << " Total trades: " << bestTotalTrades 
+            << " Win ratio: " << bestWinRatio << std::endl;
+    std::cout << summary.str() << std::flush;
+
+    // Every trade of the best configuration, for analysis.
+    if (bestRun != nullptr && bestRun->result.trades) {
+        std::string tradesOutput = ResultsSink::uniquePath(outputDir + "/trades_" + symbol + "_" + dateStr, ".csv");
+        if (!bestRun->result.trades->writeCsv(tradesOutput)) {
+            std::cerr << "Error: Could not write " << tradesOutput << std::endl;
+        }
+    }
 }
 
 int main() {
@@ -130,12 +177,17 @@ int main() {
     // Stop if any of the csv files are not valid.
     if (!csvOrderCorrect) return 10;
 
-    // Process each symbol
+    // Process the symbols concurrently; each one's parameter combinations run as nested tasks
+    // on the same pool.
+    TaskGroup symbolTasks(trader.pool());
     for (const auto &symbol : symbols) {
-        runOptimizationForSymbol(symbol, inputDirectory, outputDirectory,
-                                 lookbackDaysArray, applyTradesArray,
-                                 sensitivityValues, tpslValues, trader);
+        symbolTasks.run([&, symbol]() {
+            runOptimizationForSymbol(symbol, inputDirectory, outputDirectory,
+                                     lookbackDaysArray, applyTradesArray,
+                                     sensitivityValues, tpslValues, trader);
+        });
     }
+    symbolTasks.wait();
 
     auto endTime = std::chrono::high_resolution_clock::now();
     std::chrono::duration<double> elapsed = endTime - startTime;
@@ -0,0 +1,132 @@
+// Regression check: a window whose optimization finds no winner is applied with the zero
+// ResultHighBroke, i.e. sensitivity 0. A zero-width channel is the bar's own close, so like the
+// original full-scan loop the kernels must never see a breakout and never trade, whether they track
+// the channel themselves or read a precomputed one.
+
+#include <cstdio>
+#include <filesystem>
+#include <iostream>
+#include <string>
+
+#include "FibAlgoTrader.hpp"
+#include "TradeLedger.hpp"
+
+namespace {
+
+    int failures = 0;
+
+    void expect(bool condition, const std::string &what)
+    {
+        if (!condition)
+        {
+            std::cerr << "FAILED: " << what << std::endl;
+            ++failures;
+        }
+    }
+
+    // Closes rise on every bar, so any channel that lags the current close breaks out everywhere.
+    CandleSeries risingSeries(size_t count)
+    {
+        CandleSeries series;
+        for (size_t i = 0; i < count; ++i)
+        {
+            float close = 100.0f + 0.5f * static_cast<float>(i);
+            series.push_back(DataRow{static_cast<int64_t>(i) * 60, close, close * 1.002f, close * 0.998f, close});
+        }
+        return series;
+    }
+
+    int optimizingTrades(FibAlgoTrader &trader, const CandleView &view, int sensitivity,
+                         const DonchianChannel *channel, const ExitFinder *exits)
+    {
+        int wins = 0;
+        int losses = 0;
+        float volume = 0.0f;
+        TradeSimulationParams params(view, sensitivity, 0.001f, wins, losses, 1.0f, 0, 999999,
+                                     1000.0f, 1000.0f, 1000.0f, 0, volume);
+        if (channel != nullptr)
+        {
+            params.channel_high = channel->high.data();
+            params.channel_low = channel->low.data();
+            params.breakouts = channel;
+            params.exits = exits;
+        }
+        trader.simulateTradesOptimizing(params);
+        return wins + losses;
+    }
+
+    int batchTrades(FibAlgoTrader &trader, const CandleView &view, int sensitivity,
+                    const DonchianChannel *channel, const ExitFinder *exits)
+    {
+        TradeSimulationBatchParams params(view, sensitivity);
+        params.tpsl[0] = 0.001f;
+        params.tpsl[1] = 0.002f;
+        params.lane_count = 2;
+        params.max_trades = 999999;
+        params.initial_trade_size = 1000.0f;
+        params.starting_state_balance = 1000.0f;
+        if (channel != nullptr)
+        {
+            params.channel_high = channel->high.data();
+            params.channel_low = channel->low.data();
+            params.breakouts = channel;
+            params.exits = exits;
+        }
+        TradeSimulationBatchResult result = trader.simulateTradesOptimizingBatch(params);
+        return result.wins[0] + result.losses[0] + result.wins[1] + result.losses[1];
+    }
+
+    size_t applyingTrades(FibAlgoTrader &trader, const CandleView &view, int sensitivity,
+                          const DonchianChannel *channel, const ExitFinder *exits, const std::string &logFileName)
+    {
+        int wins = 0;
+        int losses = 0;
+        float volume = 0.0f;
+        TradeLedger ledger;
+        TradeSimulationParams params(view, sensitivity, 0.001f, wins, losses, 1.0f, 0, 999999,
+                                     1000.0f, 1000.0f, 1000.0f, 0, volume);
+        params.logFileName = logFileName;
+        params.ledger = &ledger;
+        if (channel != nullptr)
+        {
+            params.channel_high = channel->high.data();
+            params.channel_low = channel->low.data();
+            params.breakouts = channel;
+            params.exits = exits;
+        }
+        trader.simulateTradesApplying(params);
+        return ledger.size();
+    }
+
+}
+
+int main()
+{
+    const CandleSeries series = risingSeries(200);
+    const CandleView view(series);
+    const DonchianChannels channels(series, {0, 2});
+    const ExitFinder exits(series);
+    FibAlgoTrader trader(1.0f, 5, 1);
+
+    const std::string logFileName =
+        (std::filesystem::temp_directory_path() / "zero_sensitivity_test_log.csv").string();
+
+    // The series does trade with a real channel, so the zero counts below mean something.
+    expect(optimizingTrades(trader, view, 2, nullptr, nullptr) > 0, "sensitivity 2 trades on the test series");
+
+    expect(optimizingTrades(trader, view, 0, nullptr, nullptr) == 0, "optimizing, rolling channel");
+    expect(optimizingTrades(trader, view, 0, channels.find(0), &exits) == 0, "optimizing, precomputed channel");
+    expect(batchTrades(trader, view, 0, nullptr, nullptr) == 0, "batch, rolling channel");
+    expect(batchTrades(trader, view, 0, channels.find(0), &exits) == 0, "batch, precomputed channel");
+    expect(applyingTrades(trader, view, 0, nullptr, nullptr, logFileName) == 0, "applying, rolling channel");
+    expect(applyingTrades(trader, view, 0, channels.find(0), &exits, logFileName) == 0,
+           "applying, precomputed channel");
+
+    std::error_code ec;
+    std::filesystem::remove(logFileName, ec);
+
+    if (failures > 0)
+        return 1;
+    std::cout << "zero_sensitivity_test passed" << std::endl;
+    return 0;
+}
@@ -0,0 +1,154 @@
+// Converts a binary equity log (EquityLog.hpp), or the balance curve rebuilt from an event log
+// (TradeEventLog.hpp), into
+//   .csv - the "Open time,Open,High,Low,Close,Balance" trading log, candles read from the cache
+//   .npy - a NumPy structured array (open_time datetime64[s], balance float64) for np.load(mmap_mode='r')
+//
+// Usage: equity_convert <log.equity> <output.csv|output.npy> [candles.csv]
+//        equity_convert <all_trading_events_*.csv> <output.csv|output.npy> <candles.csv>
+// The candle CSV of an equity log defaults to the one recorded in the log.
+
+#include <algorithm>
+#include <cstdint>
+#include <cstring>
+#include <filesystem>
+#include <fstream>
+#include <iostream>
+#include <string>
+#include <vector>
+
+#include "AsyncLogWriter.hpp"
+#include "CandleLoader.hpp"
+#include "EquityLog.hpp"
+#include "HelperFunctions.hpp"
+#include "TradeEventLog.hpp"
+
+namespace {
+
+    bool endsWith(const std::string &text, const std::string &suffix)
+    {
+        return text.size() >= suffix.size() && text.compare(text.size() - suffix.size(), suffix.size(), suffix) == 0;
+    }
+
+    struct Records
+    {
+        const EquityLog::EquityRecord *data = nullptr;
+        size_t count = 0;
+    };
+
+    bool loadCandles(const std::string &candlesPath, CandleSeries &candles)
+    {
+        candles = CandleLoader::load(candlesPath);
+        if (candles.empty())
+        {
+            std::cerr << "Error: No candles found in " << candlesPath << std::endl;
+            return false;
+        }
+        return true;
+    }
+
+    bool writeNpy(const Records &records, const std::string &path)
+    {
+        static_assert(sizeof(EquityLog::EquityRecord) == 16, "the descr below must match EquityRecord");
+
+        std::string dict = "{'descr': [('open_time', '<M8[s]'), ('balance', '<f8')], 'fortran_order': False, 'shape': (" +
+                           std::to_string(records.count) + ",), }";
+        // Magic, version and length take 10 bytes; the header is space padded so the data starts
+        // 64 byte aligned, and ends with a newline.
+        const size_t padded = (10 + dict.size() + 1 + 63) / 64 * 64;
+        dict.append(padded - 10 - dict.size() - 1, ' ');
+        dict.push_back('\n');
+        const uint16_t dictLength = static_cast<uint16_t>(dict.size());
+
+        std::ofstream out(path, std::ios::out | std::ios::binary | std::ios::trunc);
+        if (!out.is_open())
+            return false;
+        out.write("\x93NUMPY\x01\x00", 8);
+        const char lengthBytes[2] = {static_cast<char>(dictLength & 0xFF), static_cast<char>(dictLength >> 8)};
+        out.write(lengthBytes, 2);
+        out.write(dict.data(), static_cast<std::streamsize>(dict.size()));
+        // The records are already little-endian int64 / float64 pairs.
+        out.write(reinterpret_cast<const char *>(records.data),
+                  static_cast<std::streamsize>(records.count * sizeof(EquityLog::EquityRecord)));
+        return out.good();
+    }
+
+    bool writeCsv(const Records &records, const CandleSeries &candles, const std::string &path)
+    {
+        // The writer appends, so start from an empty file.
+        std::error_code ec;
+        std::filesystem::remove(path, ec);
+        AsyncLogWriter log(path);
+        if (!log.isOpen())
+            return false;
+
+        const int64_t *time = candles.open_time();
+        const int64_t *timeEnd = time + candles.size();
+        size_t next = 0; // logged bars are usually consecutive candles
+        for (size_t r = 0; r < records.count; ++r)
+        {
+            const EquityLog::EquityRecord &record = records.data[r];
+            size_t c = next;
+            if (c >= candles.size() || time[c] != record.open_time)
+                c = std::lower_bound(time, timeEnd, record.open_time) - time;
+            if (c >= candles.size() || time[c] != record.open_time)
+            {
+                std::cerr << "Error: No candle at " << HelperFunctions::formatTimestamp(record.open_time) << std::endl;
+                return false;
+            }
+            log.push(LogRecord{time[c], candles.open()[c], candles.high()[c], candles.low()[c],
+                               candles.close()[c], record.balance});
+            next = c + 1;
+        }
+        return true;
+    }
+
+}
+
+int main(int argc, char *argv[])
+{
+    if (argc < 3 || argc > 4)
+    {
+        std::cerr << "Usage: " << argv[0] << " <log.equity> <output.csv|output.npy> [candles.csv]\n"
+                  << "       " << argv[0] << " <all_trading_events_*.csv> <output.csv|output.npy> <candles.csv>" << std::endl;
+        return 1;
+    }
+    const std::string logPath = argv[1];
+    const std::string outputPath = argv[2];
+    const bool toNpy = endsWith(outputPath, ".npy");
+
+    EquityLog::Curve curve;
+    std::vector<EquityLog::EquityRecord> rebuilt;
+    CandleSeries candles;
+    Records records;
+    if (endsWith(logPath, ".csv"))
+    {
+        if (argc != 4)
+        {
+            std::cerr << "Error: Rebuilding the curve of an event log needs its candle CSV." << std::endl;
+            return 1;
+        }
+        if (!loadCandles(argv[3], candles) || !TradeEventLog::reconstructCurve(logPath, candles, rebuilt))
+            return 1;
+        records = {rebuilt.data(), rebuilt.size()};
+    }
+    else
+    {
+        if (!EquityLog::open(logPath, curve))
+        {
+            std::cerr << "Error: " << logPath << " is not a valid equity log." << std::endl;
+            return 1;
+        }
+        if (!toNpy && !loadCandles(argc == 4 ? argv[3] : curve.source_csv, candles))
+            return 1;
+        records = {curve.records, curve.row_count};
+    }
+
+    const bool written = toNpy ? writeNpy(records, outputPath) : writeCsv(records, candles, outputPath);
+    if (!written)
+    {
+        std::cerr << "Error: Could not write " << outputPath << std::endl;
+        return 1;
+    }
+    std::cout << "Wrote " << records.count << " rows to " << outputPath << std::endl;
+    return 0;
+}
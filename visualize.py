@@ -1,37 +1,42 @@
 import os
+import numpy as np
 import pandas as pd
 import matplotlib.pyplot as plt
 
+def read_trading_log(file_path):
+    # .npy curves (written by equity_convert) are memory-mapped; CSV logs are parsed.
+    if file_path.endswith(".npy"):
+        curve = np.load(file_path, mmap_mode='r')
+        return pd.DataFrame({'Open time': curve['open_time'], 'Balance': curve['balance']})
+
+    data = pd.read_csv(file_path)
+    data['Open time'] = pd.to_datetime(data['Open time'])
+    return data
+
 def visualize_all_trading_logs(output_dir):
-    # Find CSV files that start with "all_trading_logs_"
-    csv_files = [f for f in os.listdir(output_dir) if f.startswith("all_trading_logs_") and f.endswith(".csv")]
+    # Find trading logs that start with "all_trading_logs_"
+    log_files = [f for f in os.listdir(output_dir)
+                 if f.startswith("all_trading_logs_") and (f.endswith(".csv") or f.endswith(".npy"))]
     
-    if not csv_files:
-        print("No trading log CSV files found in", output_dir)
+    if not log_files:
+        print("No trading log CSV or NPY files found in", output_dir)
         return
 
-    # Process each CSV file
-    for csv_file in csv_files:
-        file_path = os.path.join(output_dir, csv_file)
+    # Process each log file
+    for log_file in log_files:
+        file_path = os.path.join(output_dir, log_file)
         try:
-            data = pd.read_csv(file_path)
+            data = read_trading_log(file_path)
         except Exception as e:
             print(f"Error reading {file_path}: {e}")
             continue
 
-        # Convert 'Open time' column to datetime
-        try:
-            data['Open time'] = pd.to_datetime(data['Open time'])
-        except Exception as e:
-            print(f"Error parsing dates in {file_path}: {e}")
-            continue
-
         # Optionally filter out rows if you only want to plot when the balance changes:
         # filtered_data = data[data['Balance'].diff() != 0]
         filtered_data = data  # plotting all rows
 
         # Extract header for the figure by removing the prefix and suffix
-        header = csv_file.replace("all_trading_logs_", "").replace(".csv", "")
+        header = os.path.splitext(log_file)[0].replace("all_trading_logs_", "")
         
         # Create and display the plot
         plt.figure(figsize=(12, 6))